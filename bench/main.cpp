@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Results are written as JSON to bench-cppargs.json unless --benchmark_out is
+// given, so runs on different commits can be compared, e.g. with
+// google-benchmark's tools/compare.py.
+int main(int argc, char **argv)
+{
+    std::vector<char *> args(argv, argv + argc);
+
+    std::string out = "--benchmark_out=bench-cppargs.json";
+    std::string out_format = "--benchmark_out_format=json";
+    bool is_out_given = false;
+    for (std::string_view arg : args)
+    {
+        is_out_given = is_out_given or arg.starts_with("--benchmark_out=");
+    }
+    if (not is_out_given)
+    {
+        args.push_back(out.data());
+        args.push_back(out_format.data());
+    }
+
+    int num_args = args.size();
+    benchmark::Initialize(&num_args, args.data());
+    if (benchmark::ReportUnrecognizedArguments(num_args, args.data()))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
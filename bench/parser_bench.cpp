@@ -0,0 +1,520 @@
+#include <benchmark/benchmark.h>
+
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "Parser.h"
+
+using namespace cppargs;
+
+namespace {
+
+// short names of flags, 'h' is taken by help
+const std::string short_names = "abcdefgijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// Schema of num_definitions arguments: every fourth one is an option, every
+// fourth a vector option of 3 values, the rest are flags. The first flags get
+// short names.
+struct Schema
+{
+    Parser parser;
+    std::vector<std::string> flags, options, vec_options;
+
+    explicit Schema(int num_definitions)
+    {
+        for (int i = 0; i < num_definitions; i++)
+        {
+            std::string id = std::to_string(i);
+            if (i % 4 == 2)
+            {
+                options.push_back("option" + id);
+                parser.add_option(options.back(), "option " + id, false, "0");
+            } else if (i % 4 == 3)
+            {
+                vec_options.push_back("vec" + id);
+                parser.add_vec_option(vec_options.back(), "vector option " + id,
+                                      3, false);
+            } else
+            {
+                flags.push_back("flag" + id);
+                char short_name = flags.size() <= short_names.size()
+                                      ? short_names[flags.size() - 1]
+                                      : '\0';
+                parser.add_flag(short_name, flags.back(), "flag " + id);
+            }
+        }
+    }
+
+    // clusters of the short flags defined, e.g. "-abc"
+    std::string cluster(std::size_t i) const
+    {
+        std::size_t num_short = std::min(flags.size(), short_names.size());
+        if (num_short == 0)
+        {
+            return "-x";
+        }
+        std::string item = "-";
+        for (std::size_t j = 0; j < 3; j++)
+        {
+            item += short_names[(i + j) % num_short];
+        }
+        return item;
+    }
+};
+
+enum class Mix
+{
+    Mixed,
+    Clusters,
+    Positionals,
+    // "--option2=42", as generated by wrapper scripts
+    KeyValue
+};
+
+// argv of exactly num_items items (including the program name)
+struct CmdLineItems
+{
+    std::vector<std::string> items;
+    std::vector<char *> argv;
+
+    CmdLineItems(const Schema &schema, Mix mix, std::size_t num_items)
+    {
+        items.reserve(num_items);
+        items.emplace_back("bench-cppargs");
+        for (std::size_t i = 0; items.size() < num_items; i++)
+        {
+            std::size_t left = num_items - items.size();
+            std::size_t kind = mix == Mix::Mixed ? i % 4 : 0;
+            if (mix == Mix::KeyValue and not schema.options.empty())
+            {
+                items.push_back("--" +
+                                schema.options[i % schema.options.size()] +
+                                "=" + std::to_string(i));
+            } else if (mix == Mix::Clusters or kind == 0)
+            {
+                items.push_back(mix == Mix::Positionals
+                                    ? "file" + std::to_string(i) + ".txt"
+                                    : schema.cluster(i));
+            } else if (kind == 1 and left >= 2 and not schema.options.empty())
+            {
+                items.push_back(
+                    "--" + schema.options[i % schema.options.size()]);
+                items.push_back("42");
+            } else if (kind == 2 and left >= 4 and
+                       not schema.vec_options.empty())
+            {
+                items.push_back(
+                    "--" + schema.vec_options[i % schema.vec_options.size()]);
+                items.insert(items.end(), {"1.5", "-2", "3e2"});
+            } else
+            {
+                items.push_back("file" + std::to_string(i) + ".txt");
+            }
+        }
+
+        for (std::string &item : items)
+        {
+            argv.push_back(item.data());
+        }
+    }
+};
+
+void parse(benchmark::State &state, Mix mix)
+{
+    Schema schema(state.range(0));
+    CmdLineItems cmd_line(schema, mix, state.range(1));
+
+    for (auto _ : state)
+    {
+        Args args = schema.parser.parse_args(cmd_line.argv.size(),
+                                             cmd_line.argv.data());
+        benchmark::DoNotOptimize(args);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+void BM_ParseArgsMixed(benchmark::State &state) { parse(state, Mix::Mixed); }
+void BM_ParseArgsClusters(benchmark::State &state)
+{
+    parse(state, Mix::Clusters);
+}
+void BM_ParseArgsPositionals(benchmark::State &state)
+{
+    parse(state, Mix::Positionals);
+}
+void BM_ParseArgsKeyValue(benchmark::State &state)
+{
+    parse(state, Mix::KeyValue);
+}
+
+// mixed command lines parsed into an arena released after every parse
+void BM_ParseArgsArena(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    CmdLineItems cmd_line(schema, Mix::Mixed, state.range(1));
+    std::pmr::monotonic_buffer_resource arena;
+
+    for (auto _ : state)
+    {
+        {
+            Args args = schema.parser.parse_args(
+                cmd_line.argv.size(), cmd_line.argv.data(), &arena);
+            benchmark::DoNotOptimize(args);
+        }
+        arena.release();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// mixed command lines streamed to a visitor counting what it sees
+class CountingVisitor : public ArgumentVisitor
+{
+public:
+    std::size_t num_items = 0;
+
+    bool on_flag(ArgumentId) override { return ++num_items != 0; }
+    bool on_option(ArgumentId, std::string_view) override
+    {
+        return ++num_items != 0;
+    }
+    bool on_positional(std::size_t, std::string_view) override
+    {
+        return ++num_items != 0;
+    }
+};
+
+void BM_Visit(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    CmdLineItems cmd_line(schema, Mix::Mixed, state.range(1));
+    CountingVisitor visitor;
+
+    for (auto _ : state)
+    {
+        schema.parser.visit(cmd_line.argv.size(), cmd_line.argv.data(),
+                            visitor);
+    }
+    benchmark::DoNotOptimize(visitor.num_items);
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// settings of a service, filled from the command line
+struct Settings
+{
+    bool verbose = false;
+    bool daemon = false;
+    int threads = 0;
+    int port = 0;
+    double timeout = 0;
+    std::string host;
+    std::string log_file;
+    std::vector<int> ports;
+};
+
+const std::vector<std::string> settings_cmd_line = {
+    "server", "-v", "--daemon", "--threads", "16", "--port=8080",
+    "--timeout", "2.5", "--host", "localhost", "--log-file",
+    "/var/log/server.log", "--ports", "80", "443", "8443"};
+
+// typed handles, then copied into Settings
+void BM_ParseTypedArgs(benchmark::State &state)
+{
+    Parser parser;
+    FlagHandle verbose = parser.add_flag('v', "verbose", "print more");
+    FlagHandle daemon = parser.add_flag("daemon", "run in the background");
+    OptionHandle<int> threads =
+        parser.add_option<int>("threads", "number of threads", false, "1");
+    OptionHandle<int> port = parser.add_option<int>("port", "port", false, "");
+    OptionHandle<double> timeout =
+        parser.add_option<double>("timeout", "timeout", false, "");
+    OptionHandle<std::string> host =
+        parser.add_option<std::string>("host", "host", false, "");
+    OptionHandle<std::string> log_file =
+        parser.add_option<std::string>("log-file", "log file", false, "");
+    VecOptionHandle<int> ports =
+        parser.add_vec_option<int>("ports", "more ports", 3, false);
+
+    Args args;
+    for (auto _ : state)
+    {
+        parser.parse_args(settings_cmd_line, args);
+        Settings settings;
+        settings.verbose = args[verbose];
+        settings.daemon = args[daemon];
+        settings.threads = args[threads];
+        settings.port = args[port];
+        settings.timeout = args[timeout];
+        settings.host = args[host];
+        settings.log_file = args[log_file];
+        settings.ports = args[ports];
+        benchmark::DoNotOptimize(settings);
+    }
+}
+
+void BM_ParseIntoStruct(benchmark::State &state)
+{
+    Parser parser;
+    parser.bind_flag(&Settings::verbose, 'v', "verbose", "print more");
+    parser.bind_flag(&Settings::daemon, "daemon", "run in the background");
+    parser.bind_option(&Settings::threads, "threads", "number of threads",
+                       false, "1");
+    parser.bind_option(&Settings::port, "port", "port", false, "");
+    parser.bind_option(&Settings::timeout, "timeout", "timeout", false, "");
+    parser.bind_option(&Settings::host, "host", "host", false, "");
+    parser.bind_option(&Settings::log_file, "log-file", "log file", false, "");
+    parser.bind_vec_option(&Settings::ports, "ports", "more ports", 3, false);
+
+    for (auto _ : state)
+    {
+        Settings settings;
+        parser.parse_args(settings_cmd_line, settings);
+        benchmark::DoNotOptimize(settings);
+    }
+}
+
+// 10k command lines of 20 items against 100 definitions
+void BM_ParseBatch(benchmark::State &state)
+{
+    Schema schema(100);
+    CmdLineItems cmd_line(schema, Mix::Mixed, 20);
+    std::vector<std::string_view> items(cmd_line.items.begin(),
+                                        cmd_line.items.end());
+    std::vector<std::vector<std::string_view>> cmd_lines(10000, items);
+
+    for (auto _ : state)
+    {
+        std::vector<Args> results =
+            schema.parser.parse_batch(cmd_lines, state.range(0));
+        benchmark::DoNotOptimize(results);
+    }
+    state.SetItemsProcessed(state.iterations() * cmd_lines.size());
+}
+
+// a tool of subcommands with 50 definitions each, from defining all of them
+// to parsing one
+void BM_SubcommandStartup(benchmark::State &state)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < state.range(0); i++)
+    {
+        names.push_back("command" + std::to_string(i));
+    }
+    std::vector<std::string> cmd_line = {"bench-cppargs", names.back(), "-a",
+                                         "--option2", "42"};
+
+    for (auto _ : state)
+    {
+        Parser parser;
+        for (const std::string &name : names)
+        {
+            parser.add_subcommand(name, "subcommand", [](Parser &subcommand) {
+                for (int i = 0; i < 50; i++)
+                {
+                    std::string id = std::to_string(i);
+                    if (i % 4 == 2)
+                    {
+                        subcommand.add_option("option" + id, "option", false,
+                                              "0");
+                    } else
+                    {
+                        subcommand.add_flag(i < 26 ? short_names[i] : '\0',
+                                            "flag" + id, "flag");
+                    }
+                }
+            });
+        }
+        Args args = parser.parse_args(cmd_line);
+        benchmark::DoNotOptimize(args);
+    }
+}
+
+// 100 abbreviated long names: --abbreviated-1-option as --abbreviated-1-
+void BM_ParseAbbreviations(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    schema.parser.allow_abbreviations();
+    std::vector<std::string> cmd_line = {"bench-cppargs"};
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        std::string prefix = "abbreviated-" + std::to_string(i) + "-";
+        schema.parser.add_option(prefix + "option", "option", false, "");
+        cmd_line.push_back("--" + prefix);
+        cmd_line.push_back("42");
+    }
+
+    for (auto _ : state)
+    {
+        Args args = schema.parser.parse_args(cmd_line);
+        benchmark::DoNotOptimize(args);
+    }
+}
+
+// completing a long name prefix, with the completion index already built
+void BM_Complete(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    std::vector<std::string_view> words = {"bench-cppargs", "--flag1"};
+    schema.parser.complete(words, 1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(schema.parser.complete(words, 1));
+    }
+}
+
+// a TAB press: the only completion of a process, answered by parse_args
+void BM_CompleteFirst(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    std::vector<std::string> cmd_line = {"bench-cppargs", "__complete", "1",
+                                         "bench-cppargs", "--flag1"};
+
+    // the candidates are formatted, but not written
+    std::cout.setstate(std::ios::badbit);
+    for (auto _ : state)
+    {
+        schema.parser.add_description("benchmark");
+        benchmark::DoNotOptimize(schema.parser.parse_args(cmd_line));
+    }
+    std::cout.clear();
+}
+
+// composing the help after the definitions changed
+void BM_ComposeHelp(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+
+    for (auto _ : state)
+    {
+        schema.parser.add_description("benchmark");
+        benchmark::DoNotOptimize(schema.parser.help_message());
+    }
+}
+
+// parse_args of the program name only, help is not composed
+void BM_ParseProgramName(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    CmdLineItems cmd_line(schema, Mix::Positionals, 1);
+
+    for (auto _ : state)
+    {
+        Args args = schema.parser.parse_args(cmd_line.argv.size(),
+                                             cmd_line.argv.data());
+        benchmark::DoNotOptimize(args);
+    }
+}
+
+void BM_ArgsLookup(benchmark::State &state)
+{
+    Schema schema(state.range(0));
+    CmdLineItems cmd_line(schema, Mix::Mixed, 1000);
+    Args args =
+        schema.parser.parse_args(cmd_line.argv.size(), cmd_line.argv.data());
+
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        const std::string &flag = schema.flags[i % schema.flags.size()];
+        benchmark::DoNotOptimize(args[flag]);
+        if (not schema.options.empty())
+        {
+            const std::string &option =
+                schema.options[i % schema.options.size()];
+            benchmark::DoNotOptimize(args.get_value<int>(option));
+        }
+        i++;
+    }
+}
+
+template <typename T>
+void BM_ConvertValue(benchmark::State &state)
+{
+    std::vector<std::string> values = {"0", "42", "-17", "123456", "3"};
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        values = {"0.5", "-1.25e3", "3.14159", "1e-9", "42"};
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            utils::convert_value<T>(values[i++ % values.size()]));
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ParseArgsMixed)
+    ->ArgNames({"definitions", "argv"})
+    ->ArgsProduct({benchmark::CreateRange(1, 10000, 10),
+                   benchmark::CreateRange(1, 1000000, 10)})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseArgsClusters)
+    ->ArgNames({"definitions", "argv"})
+    ->ArgsProduct({{100}, benchmark::CreateRange(1, 1000000, 10)})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseArgsPositionals)
+    ->ArgNames({"definitions", "argv"})
+    ->ArgsProduct({{100}, benchmark::CreateRange(1, 1000000, 10)})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseArgsKeyValue)
+    ->ArgNames({"definitions", "argv"})
+    ->ArgsProduct({{100}, benchmark::CreateRange(1, 1000000, 10)})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseArgsArena)
+    ->ArgNames({"definitions", "argv"})
+    ->ArgsProduct({{100}, {10, 100, 1000}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Visit)
+    ->ArgNames({"definitions", "argv"})
+    ->ArgsProduct({{100}, {10, 100, 1000}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseTypedArgs);
+BENCHMARK(BM_ParseIntoStruct);
+BENCHMARK(BM_ParseBatch)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SubcommandStartup)
+    ->ArgName("subcommands")
+    ->RangeMultiplier(10)
+    ->Range(1, 1000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseAbbreviations)
+    ->ArgName("definitions")
+    ->RangeMultiplier(10)
+    ->Range(10, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Complete)
+    ->ArgName("definitions")
+    ->RangeMultiplier(10)
+    ->Range(10, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CompleteFirst)
+    ->ArgName("definitions")
+    ->Arg(100)
+    ->Arg(5000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ComposeHelp)
+    ->ArgName("definitions")
+    ->RangeMultiplier(10)
+    ->Range(1, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseProgramName)
+    ->ArgName("definitions")
+    ->RangeMultiplier(10)
+    ->Range(1, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ArgsLookup)
+    ->ArgName("definitions")
+    ->RangeMultiplier(10)
+    ->Range(1, 10000);
+BENCHMARK(BM_ConvertValue<int>);
+BENCHMARK(BM_ConvertValue<double>);
+BENCHMARK(BM_ConvertValue<std::string>);
@@ -8,6 +8,17 @@ workspace "cppargs"
 		"Dist"
 	}
 
+	-- premake5 --no-iostream gmake
+	filter "options:no-iostream"
+		defines "CPPARGS_NO_IOSTREAM"
+	filter {}
+
+newoption
+{
+	trigger = "no-iostream",
+	description = "Build without <iostream>, errors and help are written with stdio"
+}
+
 outputdir = "%{cfg.buildcfg}"
 
 project "cppargs"
@@ -17,7 +28,7 @@ project "cppargs"
 	kind "StaticLib"
 
 	language "C++"
-	cppdialect "C++17"
+	cppdialect "C++20"
 	--buildoptions { "-pthread" }
 
 	targetdir ("bin/" .. outputdir)
@@ -56,7 +67,7 @@ project "test-cppargs"
 	kind "ConsoleApp"
 
 	language "C++"
-	cppdialect "C++17"
+	cppdialect "C++20"
 	--buildoptions { "-pthread" }
 
 	targetdir ("bin/" .. outputdir)
@@ -74,7 +85,87 @@ project "test-cppargs"
         "%{wks.location}/src"
 	}
 
-	links {"gtest", "cppargs"}
+	links {"gtest", "cppargs", "pthread"}
+
+	filter "configurations:Debug"
+		symbols "On"
+		defines "DEBUG"
+
+	filter "configurations:Release"
+		-- defines...
+		optimize "On"
+		defines "RELEASE"
+
+	filter "configurations:Dist"
+		-- defines...
+		optimize "On"
+
+
+project "bench-cppargs"
+	location "./"
+	--possible values: ConsoleApp, SharedLib, StaticLib, Makefile, Utility, Packaging
+	kind "ConsoleApp"
+
+	language "C++"
+	cppdialect "C++20"
+	buildoptions { "-pthread" }
+
+	targetdir ("bin/" .. outputdir)
+	objdir ("build/" .. outputdir)
+
+
+	files
+	{
+		"bench/**.h",
+		"bench/**.cpp"
+	}
+
+	includedirs
+	{
+        "%{wks.location}/src"
+	}
+
+	links {"benchmark", "cppargs", "pthread"}
+
+	filter "configurations:Debug"
+		symbols "On"
+		defines "DEBUG"
+
+	filter "configurations:Release"
+		-- defines...
+		optimize "On"
+		defines "RELEASE"
+
+	filter "configurations:Dist"
+		-- defines...
+		optimize "On"
+
+
+project "example-cppargs"
+	location "./"
+	--possible values: ConsoleApp, SharedLib, StaticLib, Makefile, Utility, Packaging
+	kind "ConsoleApp"
+
+	language "C++"
+	cppdialect "C++20"
+	--buildoptions { "-pthread" }
+
+	targetdir ("bin/" .. outputdir)
+	objdir ("build/" .. outputdir)
+
+
+	files
+	{
+		"example/**.h",
+		"example/**.cpp"
+	}
+
+	includedirs
+	{
+        "%{wks.location}/src"
+	}
+
+	links {"cppargs"}
 
 	filter "configurations:Debug"
 		symbols "On"
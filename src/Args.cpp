@@ -1,31 +1,194 @@
 #include "Args.h"
 
 #include <algorithm>
+#include <array>
 
 namespace cppargs {
 
-bool Args::operator[](std::string name)
+bool Args::operator[](std::string_view name) const
 {
-    for (Flag &f : flags)
+    const ArgumentId *id = index ? index->find(name) : nullptr;
+    if (id == nullptr or not is_parsed(*id))
     {
-        if (f == name)
+        return false;
+    }
+    return id->kind != ArgumentKind::Flag or flags[id->index];
+}
+
+const ArgumentId *Args::find(std::string_view name, ArgumentKind kind) const
+{
+    const ArgumentId *id = index ? index->find(name) : nullptr;
+    if (id == nullptr or id->kind != kind or not is_parsed(*id))
+    {
+        return nullptr;
+    }
+    return id;
+}
+
+// false for arguments defined after these Args were parsed
+bool Args::is_parsed(ArgumentId id) const
+{
+    if (not definitions)
+    {
+        return false;
+    }
+    switch (id.kind)
+    {
+        case ArgumentKind::Flag:
+            return id.index < flags.size();
+        case ArgumentKind::Option:
+            return id.index < definitions->options.size();
+        case ArgumentKind::VectorOption:
+            return id.index < definitions->vec_options.size();
+        case ArgumentKind::Positional:
+            return id.index < positionals.size();
+    }
+    return false;
+}
+
+// A stable LSD radix sort on kind and index, a byte per pass, as long command
+// lines repeat a few options many times. Short ones are sorted in place.
+void Args::sort_given_options()
+{
+    auto is_before = [](const GivenOption &a, const GivenOption &b) {
+        return a.id < b.id or (a.id == b.id and a.position < b.position);
+    };
+    if (given_options.size() <= 64)
+    {
+        std::sort(given_options.begin(), given_options.end(), is_before);
+        return;
+    }
+
+    std::size_t max_index = 0;
+    for (const GivenOption &given : given_options)
+    {
+        max_index = std::max(max_index, given.id.index);
+    }
+    auto key = [&](const GivenOption &given) {
+        return static_cast<std::size_t>(given.id.kind) * (max_index + 1) +
+               given.id.index;
+    };
+    std::size_t max_key = 3 * (max_index + 1) + max_index;
+
+    std::pmr::vector<GivenOption> &sorted = sort_buffer;
+    sorted.resize(given_options.size());
+    for (std::size_t shift = 0; shift < 64 and (max_key >> shift) > 0;
+         shift += 8)
+    {
+        std::array<std::size_t, 257> starts{};
+        for (const GivenOption &given : given_options)
         {
-            return f.status;
+            starts[((key(given) >> shift) & 0xff) + 1]++;
         }
+        for (std::size_t byte = 1; byte < starts.size(); byte++)
+        {
+            starts[byte] += starts[byte - 1];
+        }
+        for (const GivenOption &given : given_options)
+        {
+            sorted[starts[(key(given) >> shift) & 0xff]++] = given;
+        }
+        given_options.swap(sorted);
     }
+}
 
-    return is_argument_defined(options, name) or
-           is_argument_defined(vec_options, name) or
-           is_argument_defined(positionals, name);
+std::span<const Args::GivenOption> Args::occurrences(ArgumentId id) const
+{
+    auto first = std::lower_bound(
+        given_options.begin(), given_options.end(), id,
+        [](const GivenOption &given, ArgumentId id) { return given.id < id; });
+    auto last = std::upper_bound(
+        first, given_options.end(), id,
+        [](ArgumentId id, const GivenOption &given) { return id < given.id; });
+    return {first, last};
+}
+
+std::span<const Args::GivenOption> Args::occurrences(ArgumentKind kind) const
+{
+    auto first = std::lower_bound(
+        given_options.begin(), given_options.end(), kind,
+        [](const GivenOption &given, ArgumentKind kind) {
+            return given.id.kind < kind;
+        });
+    auto last = std::upper_bound(
+        first, given_options.end(), kind,
+        [](ArgumentKind kind, const GivenOption &given) {
+            return kind < given.id.kind;
+        });
+    return {first, last};
+}
+
+// nullptr if no value was given for the option
+const std::string_view *Args::given_value(std::size_t index) const
+{
+    std::span<const GivenOption> given =
+        occurrences({ArgumentKind::Option, index});
+    for (auto it = given.rbegin(); it != given.rend(); ++it)
+    {
+        if (it->num_values == 1)
+        {
+            return &values[it->first_value];
+        }
+    }
+    return nullptr;
+}
+
+std::string_view Args::option_value(std::size_t index) const
+{
+    const std::string_view *value = given_value(index);
+    return value ? *value
+                 : std::string_view(
+                       definitions->options[index].get_default_value());
+}
+
+bool Args::has_value(std::size_t index) const
+{
+    return given_value(index) != nullptr or
+           not definitions->options[index].get_default_value().empty();
+}
+
+void Args::fail(ParseResult *errors, const ParseError &error) const
+{
+    if (errors != nullptr)
+    {
+        errors->error_list.push_back(error);
+    } else if (not error_sink)
+    {
+        ErrorMessages::print_error(ParseResult::message(error));
+    } else if (*error_sink)
+    {
+        (*error_sink)(ParseResult::message(error));
+    }
+}
+
+std::size_t Args::option_position(ArgumentId id, std::string_view value) const
+{
+    for (const GivenOption &given : occurrences(id))
+    {
+        for (std::uint32_t i = 0; i < given.num_values; i++)
+        {
+            if (values[given.first_value + i].data() == value.data())
+            {
+                return given.position;
+            }
+        }
+    }
+    return ParseError::no_token;
 }
 
-bool Args::is_defined(std::string name)
+std::string_view Args::positional_name(std::size_t position) const
 {
-    return is_argument_defined(flags, name) or
-           is_argument_defined(options, name) or
-           is_argument_defined(vec_options, name) or
-           is_argument_defined(positionals, name);
+    return definitions and position < definitions->positionals.size()
+               ? std::string_view(definitions->positionals[position].long_name)
+               : std::string_view();
 }
 
+template int Args::get_value<int>(std::string_view, ParseResult *) const;
+template long Args::get_value<long>(std::string_view, ParseResult *) const;
+template double Args::get_value<double>(std::string_view, ParseResult *) const;
+template std::string Args::get_value<std::string>(std::string_view,
+                                                  ParseResult *) const;
+template std::string_view Args::get_value<std::string_view>(
+    std::string_view, ParseResult *) const;
 
 }  // namespace cppargs
@@ -1,139 +1,270 @@
 #pragma once
 
-#include <iostream>
-#include <sstream>
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Argument.h"
-#include "ErrorMessages.h"
+#include "Handles.h"
+#include "NameIndex.h"
+#include "ParseResult.h"
 #include "utils.h"
 
 namespace cppargs {
 
-using ErrorMessages::print_error;
-
 class Args
 {
     friend class Parser;
 
 public:
-    std::string program_name;
+    // containers of parsed arguments are allocated with it
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    Args() = default;
+    explicit Args(allocator_type allocator)
+        : program_name(allocator), flags(allocator), given_options(allocator),
+          sort_buffer(allocator), values(allocator), positionals(allocator),
+          result(allocator), typed_values(allocator)
+    {}
+
+    std::pmr::string program_name;
+
+    // i flag with true status, or has value
+    bool operator[](std::string_view name) const;
+
+    bool operator[](FlagHandle flag) const
+    {
+        return flag.index < flags.size() and flags[flag.index];
+    }
+
+    // values converted during parsing, no lookup or conversion here
+    template <typename T>
+    const T &operator[](OptionHandle<T> option) const
+    {
+        return typed_value<T>(option.slot);
+    }
+
+    template <typename T>
+    const std::vector<T> &operator[](VecOptionHandle<T> vec_option) const
+    {
+        return typed_value<std::vector<T>>(vec_option.slot);
+    }
 
-    bool operator[](std::string name);  // i flag with true status, or has value
+    template <typename T>
+    const T &operator[](PositionalHandle<T> positional) const
+    {
+        return typed_value<T>(positional.slot);
+    }
 
+    // On failure the getters return T{} and add the error to *errors or, if
+    // none is given, pass its message to the error sink of the parser. The
+    // errors refer to name.
     template <typename T>
-    T get_value(std::string name);
+    T get_value(std::string_view name, ParseResult *errors = nullptr) const;
 
     template <typename T>
-    std::vector<T> get_vec_values(std::string name);
+    std::vector<T> get_vec_values(std::string_view name,
+                                  ParseResult *errors = nullptr) const;
 
     template <typename T>
-    T get_positional(int position);
+    T get_positional(int position, ParseResult *errors = nullptr) const;
 
     template <typename T>
-    T get_positional(std::string name);
+    T get_positional(std::string_view name,
+                     ParseResult *errors = nullptr) const;
 
     template <typename T>
-    std::vector<T> get_all_positionals(int start_pos = 0);
+    std::vector<T> get_all_positionals(int start_pos = 0,
+                                       ParseResult *errors = nullptr) const;
+
+    unsigned long num_positionals() const { return positionals.size(); }
+
+    // name of the (innermost) subcommand these Args belong to, empty if none
+    std::string_view subcommand() const { return subcommand_name; }
 
-    unsigned long num_positionals() { return positionals.size(); }
+    bool errors_occured() const { return result.errors_occured(); }
+    const ParseResult &parse_result() const { return result; }
 
 private:
-    bool is_defined(std::string name);
-    template <typename CmdLineArgument>
-    bool is_argument_defined(const std::vector<CmdLineArgument> &args,
-                             std::string name);
-
-    std::vector<Flag> flags;
-    std::vector<Option> options;
-    std::vector<VectorOption> vec_options;
-    std::vector<Positional> positionals;
+    // shared with the Parser and other Args parsed with the same definitions
+    std::shared_ptr<const NameIndex> index;
+    std::shared_ptr<const Definitions> definitions;
+    const ArgumentId *find(std::string_view name, ArgumentKind kind) const;
+    bool is_parsed(ArgumentId id) const;
+
+    // An occurrence of an option or vector option on the command line. Its
+    // values are values[first_value, first_value + num_values).
+    struct GivenOption
+    {
+        ArgumentId id;
+        // of the option's name
+        std::uint32_t position;
+        std::uint32_t first_value;
+        std::uint32_t num_values;
+        bool is_complete;
+    };
+
+    // Only what was found on the command line is stored, everything else is
+    // in the definitions. given_options are sorted by id (and position) after
+    // tokenizing.
+    std::pmr::vector<bool> flags;
+    std::pmr::vector<GivenOption> given_options;
+    // kept for the next sort, when Args are reused
+    std::pmr::vector<GivenOption> sort_buffer;
+    std::pmr::vector<std::string_view> values;
+    std::pmr::vector<std::string_view> positionals;
+
+    // by id, the occurrences of each option staying in command line order
+    void sort_given_options();
+    std::span<const GivenOption> occurrences(ArgumentId id) const;
+    std::span<const GivenOption> occurrences(ArgumentKind kind) const;
+    const std::string_view *given_value(std::size_t index) const;
+    // the last value given, or the default one
+    std::string_view option_value(std::size_t index) const;
+    bool has_value(std::size_t index) const;
+    // of the option a value given for it follows (or is attached to)
+    std::size_t option_position(ArgumentId id, std::string_view value) const;
+    // calls visit(value) for all values given, in command line order
+    template <typename Visitor>
+    void visit_values(ArgumentId id, Visitor &&visit) const;
+    std::string_view positional_name(std::size_t position) const;
+
+    ParseResult result;
+    std::string_view subcommand_name;
+
+    // values of typed handles, indexed by their slots
+    std::pmr::vector<std::any> typed_values;
+    template <typename T>
+    const T &typed_value(std::size_t slot) const;
+
+    // of the parser, nullptr for Args that were not parsed (stderr)
+    std::shared_ptr<const ErrorSink> error_sink;
+    template <typename T>
+    T convert(std::string_view name, std::string_view value,
+              ParseResult *errors) const;
+    void fail(ParseResult *errors, const ParseError &error) const;
 };
 
+// T{} if the value cannot be converted
 template <typename T>
-T Args::get_value(std::string name)
+T Args::convert(std::string_view name, std::string_view value,
+                ParseResult *errors) const
 {
-    if (!this->operator[](name))
+    T converted_value{};
+    if (not utils::convert_value(value, converted_value))
     {
-        print_error(ErrorMessages::option_not_given(name));
-        return {};
+        fail(errors, {.code = ErrorCode::InvalidValue,
+                     .name = name,
+                     .value = value});
     }
+    return converted_value;
+}
 
-    std::string value;
+// default value if parsing failed
+template <typename T>
+const T &Args::typed_value(std::size_t slot) const
+{
+    if (slot < typed_values.size())
+    {
+        if (const T *value = std::any_cast<T>(&typed_values[slot]))
+        {
+            return *value;
+        }
+    }
+    static const T default_value{};
+    return default_value;
+}
 
-    for (Option &opt : options)
+template <typename Visitor>
+void Args::visit_values(ArgumentId id, Visitor &&visit) const
+{
+    for (const GivenOption &given : occurrences(id))
     {
-        if (opt.has_value() and opt == name)
+        for (std::uint32_t i = 0; i < given.num_values; i++)
         {
-            value = opt.get_value();
+            visit(values[given.first_value + i]);
         }
     }
-    return utils::convert_value<T>(value);
 }
 
 template <typename T>
-std::vector<T> Args::get_vec_values(std::string name)
+T Args::get_value(std::string_view name, ParseResult *errors) const
 {
-    if (not this->operator[](name))
+    const ArgumentId *id = find(name, ArgumentKind::Option);
+    if (id == nullptr or not has_value(id->index))
     {
-        print_error(ErrorMessages::option_not_given(name));
+        fail(errors, {.code = ErrorCode::OptionNotGiven, .name = name});
         return {};
     }
 
-    std::vector<T> return_values;
-    for (VectorOption &opt : vec_options)
+    return convert<T>(name, option_value(id->index), errors);
+}
+
+template <typename T>
+std::vector<T> Args::get_vec_values(std::string_view name,
+                                    ParseResult *errors) const
+{
+    const ArgumentId *id = find(name, ArgumentKind::VectorOption);
+    if (id == nullptr)
     {
-        if (opt.has_value() and opt == name)
-        {
-            for (std::string value : opt.get_values())
-            {
-                return_values.push_back(utils::convert_value<T>(value));
-            }
-        }
+        fail(errors, {.code = ErrorCode::OptionNotGiven, .name = name});
+        return {};
     }
+
+    std::vector<T> return_values;
+    visit_values(*id, [&](std::string_view value) {
+        return_values.push_back(convert<T>(name, value, errors));
+    });
     return return_values;
 }
 
 template <typename T>
-T Args::get_positional(int position)
+T Args::get_positional(int position, ParseResult *errors) const
 {
-    return utils::convert_value<T>(positionals.at(position).value);
+    return convert<T>(positional_name(position), positionals.at(position),
+                      errors);
 }
 
 template <typename T>
-T Args::get_positional(std::string name)
+T Args::get_positional(std::string_view name, ParseResult *errors) const
 {
-    auto it = std::find_if(positionals.begin(), positionals.end(),
-                           [&name](Positional &p) { return p == name; });
-
-    if (it != positionals.end())
+    const ArgumentId *id = find(name, ArgumentKind::Positional);
+    if (id != nullptr)
     {
-        return utils::convert_value<T>(it->value);
+        return convert<T>(name, positionals[id->index], errors);
     }
 
-    print_error(ErrorMessages::positional_not_given(name));
+    fail(errors, {.code = ErrorCode::PositionalNotGiven, .name = name});
     return {};
 }
 
 template <typename T>
-std::vector<T> Args::get_all_positionals(int start_pos)
+std::vector<T> Args::get_all_positionals(int start_pos,
+                                         ParseResult *errors) const
 {
     std::vector<T> return_values;
     return_values.reserve(positionals.size());
-    for (int i = start_pos; i < positionals.size(); i++)
+    for (std::size_t i = start_pos; i < positionals.size(); i++)
     {
-        return_values.push_back(get_positional<T>(i));
+        return_values.push_back(get_positional<T>(i, errors));
     }
     return return_values;
 }
 
-template <typename CmdLineArgument>
-bool Args::is_argument_defined(const std::vector<CmdLineArgument> &args,
-                               std::string name)
-{
-    return std::any_of(args.begin(), args.end(),
-                       [&name](const CmdLineArgument &arg) { return arg == name; });
-}
+// common types are instantiated once, in Args.cpp
+extern template int Args::get_value<int>(std::string_view, ParseResult *) const;
+extern template long Args::get_value<long>(std::string_view,
+                                           ParseResult *) const;
+extern template double Args::get_value<double>(std::string_view,
+                                               ParseResult *) const;
+extern template std::string Args::get_value<std::string>(std::string_view,
+                                                         ParseResult *) const;
+extern template std::string_view Args::get_value<std::string_view>(
+    std::string_view, ParseResult *) const;
 
 }  // namespace cppargs
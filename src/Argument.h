@@ -1,69 +1,53 @@
 #pragma once
 
-#include <regex>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "utils.h"
+
 namespace cppargs {
+
+enum class ArgumentKind
+{
+    Flag,
+    Option,
+    VectorOption,
+    Positional
+};
+
+// position of a definition in the vector of its kind
+struct ArgumentId
+{
+    ArgumentKind kind;
+    std::size_t index;
+
+    auto operator<=>(const ArgumentId &) const = default;
+};
+
 class CmdLineArgumentBase
 {
 public:
     CmdLineArgumentBase() = default;
     CmdLineArgumentBase(std::string short_name, std::string long_name,
                         std::string description)
-        : short_name(std::move(short_name)), long_name(std::move(long_name)), description(std::move(description))
+        : short_name(std::move(short_name)), long_name(std::move(long_name)),
+          description(std::move(description))
     {}
     std::string short_name;
     std::string long_name, description;
     int num_values = 0;
-
-    bool is_cmd_line_item(const std::string &cmd_line_item)
-    {
-        return regex_match(cmd_line_item, regex_for_long_name()) ||
-               regex_match(cmd_line_item, regex_for_short_name());
-    }
-
-    bool operator==(std::string name) const
-    {
-        return (long_name == name or
-                (not short_name.empty() and short_name == name));
-    }
-
-protected:
-    std::regex regex_for_long_name() const
-    {
-        return std::regex("--" + long_name);
-    }
-
-    virtual std::regex regex_for_short_name()
-    {
-        if (not short_name.empty())
-        {
-            return std::regex("-" + short_name);
-        }
-        return {};
-    }
 };
 
 class Flag : public CmdLineArgumentBase
 {
 public:
     Flag(std::string short_name, std::string long_name, std::string description)
-        : CmdLineArgumentBase(short_name, long_name, description)
+        : CmdLineArgumentBase(std::move(short_name), std::move(long_name),
+                              std::move(description))
     {
         num_values = 0;
     }
-    bool status = false;
-
-    std::regex regex_for_short_name() override
-    {
-        if (not short_name.empty())
-        {
-            return std::regex("-[a-zA-Z]*" + short_name + "[a-zA-Z]*");
-        }
-        return {};
-    }
 };
 
 class OptionBase : public CmdLineArgumentBase
@@ -71,12 +55,11 @@ class OptionBase : public CmdLineArgumentBase
 public:
     OptionBase(std::string short_name, std::string long_name,
                std::string description, bool required)
-        : CmdLineArgumentBase(short_name, long_name, description),
+        : CmdLineArgumentBase(std::move(short_name), std::move(long_name),
+                              std::move(description)),
           required(required)
     {}
     bool required;
-    virtual void set_value(std::string val) = 0;
-    virtual bool has_value() = 0;
 };
 
 class Option : public OptionBase
@@ -84,19 +67,17 @@ class Option : public OptionBase
 public:
     Option(std::string short_name, std::string long_name,
            std::string description, bool required, std::string default_value)
-        : OptionBase(short_name, long_name, description, required),
-          value(default_value)
-
+        : OptionBase(std::move(short_name), std::move(long_name),
+                     std::move(description), required),
+          default_value(std::move(default_value))
     {
         num_values = 1;
     }
 
-    std::string get_value() { return value; }
-    void set_value(std::string val) override { value = val; }
-    bool has_value() override { return not value.empty(); }
+    const std::string &get_default_value() const { return default_value; }
 
 private:
-    std::string value;
+    std::string default_value;
 };
 
 class VectorOption : public OptionBase
@@ -104,28 +85,19 @@ class VectorOption : public OptionBase
 public:
     VectorOption(std::string short_name, std::string long_name,
                  std::string description, int num_values, bool required)
-        : OptionBase(short_name, long_name, description, required)
+        : OptionBase(std::move(short_name), std::move(long_name),
+                     std::move(description), required)
     {
         this->num_values = num_values;
     }
-
-    std::vector<std::string> get_values() { return value_vec; }
-    void set_value(std::string val) override { value_vec.push_back(val); }
-    bool has_value() override { return not value_vec.empty(); }
-
-private:
-    std::vector<std::string> value_vec;
 };
 
 class Positional : public CmdLineArgumentBase
 {
 public:
-    Positional(std::string long_name, std::string value) : value(value)
-    {
-        this->long_name = long_name;
-    }
-
-    std::string value;
+    Positional(std::string long_name, std::string description)
+        : CmdLineArgumentBase("", std::move(long_name), std::move(description))
+    {}
 };
 
 class PositionalList : public CmdLineArgumentBase
@@ -138,4 +110,17 @@ public:
 private:
 };
 
+// Arguments defined in a Parser. Parsed Args share the definitions they were
+// parsed with; the Parser copies them before adding more.
+struct Definitions
+{
+    std::vector<Flag> flags;
+    std::vector<Option> options;
+    std::vector<VectorOption> vec_options;
+    std::vector<Positional> positionals;
+    // indices of the required ones, ascending
+    std::vector<std::size_t> required_options;
+    std::vector<std::size_t> required_vec_options;
+};
+
 }  // namespace cppargs
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cppargs {
+
+// Read-only view of the command line. Items are returned as string_views
+// pointing straight into argv (or into the caller's vector), nothing gets
+// copied. The viewed storage has to outlive the Args parsed from it.
+class CmdLine
+{
+public:
+    CmdLine(int argc, char *argv[])
+        : num_items(argc < 0 ? 0 : argc), argv(argv)
+    {}
+    CmdLine(const std::vector<std::string> &items)
+        : num_items(items.size()), items(items.data())
+    {}
+    CmdLine(const std::vector<std::string_view> &items)
+        : num_items(items.size()), views(items.data())
+    {}
+    // the viewed vector has to outlive the CmdLine
+    CmdLine(std::vector<std::string> &&) = delete;
+    CmdLine(std::vector<std::string_view> &&) = delete;
+
+    // without the first item, e.g. the arguments of a subcommand
+    CmdLine tail() const
+    {
+        CmdLine rest = *this;
+        if (rest.num_items > 0)
+        {
+            rest.num_items--;
+            rest.argv = argv != nullptr ? argv + 1 : nullptr;
+            rest.items = items != nullptr ? items + 1 : nullptr;
+            rest.views = views != nullptr ? views + 1 : nullptr;
+        }
+        return rest;
+    }
+
+    std::size_t size() const { return num_items; }
+    bool empty() const { return num_items == 0; }
+
+    std::string_view operator[](std::size_t position) const
+    {
+        if (argv != nullptr)
+        {
+            return argv[position];
+        }
+        return items != nullptr ? std::string_view(items[position])
+                                : views[position];
+    }
+
+private:
+    std::size_t num_items;
+    char **argv = nullptr;
+    const std::string *items = nullptr;
+    const std::string_view *views = nullptr;
+};
+
+}  // namespace cppargs
@@ -0,0 +1,20 @@
+#include "Converter.h"
+
+#ifndef CPPARGS_NO_IOSTREAM
+#include <sstream>
+#endif
+
+namespace cppargs {
+
+#ifndef CPPARGS_NO_IOSTREAM
+bool read_from_stream(std::string_view source,
+                      void (*read)(std::istream &stream, void *value),
+                      void *value)
+{
+    std::istringstream stream{std::string(source)};
+    read(stream, value);
+    return not stream.fail() and (stream >> std::ws).eof();
+}
+#endif
+
+}  // namespace cppargs
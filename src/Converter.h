@@ -0,0 +1,142 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#ifndef CPPARGS_NO_IOSTREAM
+#include <iosfwd>
+#endif
+
+namespace cppargs {
+
+#ifndef CPPARGS_NO_IOSTREAM
+// Calls read(stream, value) with a stream of source, in Converter.cpp so that
+// <sstream> is not included here. False unless all of source was read.
+bool read_from_stream(std::string_view source,
+                      void (*read)(std::istream &stream, void *value),
+                      void *value);
+#endif
+
+// Converts command line values to T. Returns false, leaving value untouched,
+// if the whole source cannot be converted.
+//
+// This is the customization point for user types, e.g.
+//
+//   template <>
+//   struct cppargs::Converter<Color>
+//   {
+//       static bool convert(std::string_view source, Color &value);
+//   };
+//
+// Types without a specialization are read with operator>>, unless built with
+// CPPARGS_NO_IOSTREAM.
+template <typename T, typename Enable = void>
+struct Converter
+{
+    static bool convert(std::string_view source, T &value)
+    {
+#ifdef CPPARGS_NO_IOSTREAM
+        static_assert(sizeof(T) == 0,
+                      "no cppargs::Converter for this type, specialize it");
+        return false;
+#else
+        T converted_value{};
+        if (not read_from_stream(source, &read, &converted_value))
+        {
+            return false;
+        }
+        value = std::move(converted_value);
+        return true;
+#endif
+    }
+
+#ifndef CPPARGS_NO_IOSTREAM
+private:
+    static void read(std::istream &stream, void *value)
+    {
+        stream >> *static_cast<T *>(value);
+    }
+#endif
+};
+
+template <>
+struct Converter<std::string_view>
+{
+    static bool convert(std::string_view source, std::string_view &value)
+    {
+        value = source;
+        return true;
+    }
+};
+
+template <>
+struct Converter<std::string>
+{
+    static bool convert(std::string_view source, std::string &value)
+    {
+        value.assign(source);
+        return true;
+    }
+};
+
+// "1", "0", "true" or "false"
+template <>
+struct Converter<bool>
+{
+    static bool convert(std::string_view source, bool &value)
+    {
+        if (source == "1" or source == "true")
+        {
+            value = true;
+        } else if (source == "0" or source == "false")
+        {
+            value = false;
+        } else
+        {
+            return false;
+        }
+        return true;
+    }
+};
+
+// a single character
+template <>
+struct Converter<char>
+{
+    static bool convert(std::string_view source, char &value)
+    {
+        if (source.size() != 1)
+        {
+            return false;
+        }
+        value = source[0];
+        return true;
+    }
+};
+
+template <typename T>
+struct Converter<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+{
+    static bool convert(std::string_view source, T &value)
+    {
+        // from_chars does not accept an explicit plus sign
+        if (source.size() > 1 and source[0] == '+' and source[1] != '-')
+        {
+            source.remove_prefix(1);
+        }
+
+        T converted_value{};
+        const char *last = source.data() + source.size();
+        auto [ptr, ec] = std::from_chars(source.data(), last, converted_value);
+        if (ec != std::errc() or ptr != last)
+        {
+            return false;
+        }
+        value = converted_value;
+        return true;
+    }
+};
+
+}  // namespace cppargs
@@ -0,0 +1,20 @@
+#include "ErrorMessages.h"
+
+#ifdef CPPARGS_NO_IOSTREAM
+#include <cstdio>
+#else
+#include <iostream>
+#endif
+
+namespace cppargs::ErrorMessages {
+
+void print_error(const std::string &msg)
+{
+#ifdef CPPARGS_NO_IOSTREAM
+    std::fwrite(msg.data(), 1, msg.size(), stderr);
+#else
+    std::cerr << msg;
+#endif
+}
+
+}  // namespace cppargs::ErrorMessages
@@ -1,11 +1,11 @@
 #pragma once
 
-#include <iostream>
 #include <string>
 
 namespace cppargs::ErrorMessages {
 
-inline void print_error(std::string msg) { std::cerr << msg; }
+// to stderr
+void print_error(const std::string &msg);
 
 inline std::string short_name_taken(char short_name)
 {
@@ -29,6 +29,33 @@ inline std::string name_with_spaces(std::string long_name)
     return "Names cannot contain spaces (" + long_name + ")\n";
 }
 
+inline std::string subcommand_taken(std::string name)
+{
+    return "Subcommand '" + name + "' is already specified\n";
+}
+
+inline std::string invalid_subcommand_name(std::string name)
+{
+    return "Invalid subcommand name '" + name +
+           "'. Names cannot be empty, contain spaces or start with '-'\n";
+}
+
+inline std::string unknown_option(std::string name)
+{
+    return "There is no option " + name + "\n";
+}
+
+inline std::string ambiguous_option(std::string name)
+{
+    return "Option --" + name + " is ambiguous\n";
+}
+
+inline std::string unknown_short_name(char short_name, std::string cluster)
+{
+    return "There is no option -" + std::string(1, short_name) + " (in " +
+           cluster + ")\n";
+}
+
 inline std::string positional_required(std::string long_name)
 {
     return "Positional argument " + long_name + " is required!\n";
@@ -56,6 +83,11 @@ inline std::string invalid_num_of_values(std::string long_name, int num_values)
            " value(s)\n";
 }
 
+inline std::string invalid_value(std::string name, std::string value)
+{
+    return "Invalid value '" + value + "' for " + name + "\n";
+}
+
 inline std::string option_not_given(std::string name)
 {
     return "Error getting value. Option " + name + " was not given!\n";
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cppargs {
+
+// Handles are returned by Parser::add_* and give direct access to parsed
+// values: args[handle]. A default constructed handle (returned when the
+// definition was rejected) is invalid.
+
+struct FlagHandle
+{
+    static constexpr std::size_t invalid = static_cast<std::size_t>(-1);
+    std::size_t index = invalid;
+    bool is_valid() const { return index != invalid; }
+};
+
+// Typed handles refer to a slot holding the value converted to T during
+// Parser::parse_args.
+template <typename T>
+struct OptionHandle
+{
+    static constexpr std::size_t invalid = static_cast<std::size_t>(-1);
+    std::size_t slot = invalid;
+    bool is_valid() const { return slot != invalid; }
+};
+
+template <typename T>
+struct VecOptionHandle
+{
+    static constexpr std::size_t invalid = static_cast<std::size_t>(-1);
+    std::size_t slot = invalid;
+    bool is_valid() const { return slot != invalid; }
+};
+
+template <typename T>
+struct PositionalHandle
+{
+    static constexpr std::size_t invalid = static_cast<std::size_t>(-1);
+    std::size_t slot = invalid;
+    bool is_valid() const { return slot != invalid; }
+};
+
+}  // namespace cppargs
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Argument.h"
+
+namespace cppargs {
+
+struct StringHash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view str) const
+    {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+// Maps long and short names of defined arguments to their ArgumentIds.
+// Lookups take string_views, no temporary strings are created. Names are only
+// ever added, so references to ids and names stay valid while the index lives.
+class NameIndex
+{
+public:
+    void add(char short_name, const std::string &long_name, ArgumentId id)
+    {
+        long_names.emplace(long_name, id);
+        if (short_name != '\0')
+        {
+            auto letter = static_cast<unsigned char>(short_name);
+            short_names[letter] = id;
+            is_short_name_used.set(letter);
+        }
+    }
+
+    const ArgumentId *find_long(std::string_view long_name) const
+    {
+        auto it = long_names.find(long_name);
+        return it == long_names.end() ? nullptr : &it->second;
+    }
+
+    // a table load, so short clusters are decoded without hashing
+    const ArgumentId *find_short(char short_name) const
+    {
+        auto letter = static_cast<unsigned char>(short_name);
+        return is_short_name_used[letter] ? &short_names[letter] : nullptr;
+    }
+
+    // long names are at least 2 characters long, so a single character is
+    // always a short name
+    const ArgumentId *find(std::string_view name) const
+    {
+        return name.size() == 1 ? find_short(name[0]) : find_long(name);
+    }
+
+    bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+    // A view of the name that lives as long as the index, for names which are
+    // not long names of definitions (e.g. in error messages).
+    std::string_view intern(std::string_view name)
+    {
+        std::string_view stable = stable_name(name);
+        if (stable.data() != nullptr)
+        {
+            return stable;
+        }
+        return *other_names.emplace(name).first;
+    }
+
+    // empty view if the name was neither added nor interned
+    std::string_view stable_name(std::string_view name) const
+    {
+        if (auto it = long_names.find(name); it != long_names.end())
+        {
+            return it->first;
+        }
+        if (auto it = other_names.find(name); it != other_names.end())
+        {
+            return *it;
+        }
+        return {};
+    }
+
+    void reserve(std::size_t num_names)
+    {
+        long_names.reserve(num_names);
+    }
+
+private:
+    std::unordered_map<std::string, ArgumentId, StringHash, std::equal_to<>>
+        long_names;
+    // indexed by the letter
+    std::array<ArgumentId, 256> short_names{};
+    std::bitset<256> is_short_name_used;
+    std::unordered_set<std::string, StringHash, std::equal_to<>> other_names;
+};
+
+}  // namespace cppargs
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ErrorMessages.h"
+#include "NameIndex.h"
+
+namespace cppargs {
+
+template <typename... Arguments>
+class schema;
+
+enum class ErrorCode
+{
+    ShortNameTaken,
+    LongNameTaken,
+    LongNameTooShort,
+    NameWithSpaces,
+    SpecifiedInvalidNumOfValues,
+    SubcommandTaken,
+    InvalidSubcommandName,
+    UnknownOption,
+    AmbiguousOption,
+    UnknownShortName,
+    OptionRequired,
+    InvalidNumOfValues,
+    InvalidValue,
+    PositionalRequired,
+    ListRequired,
+    OptionNotGiven,
+    PositionalNotGiven
+};
+
+struct ParseError
+{
+    static constexpr std::size_t no_token = static_cast<std::size_t>(-1);
+
+    ErrorCode code;
+    // long name of the definition
+    std::string_view name = {};
+    // position of the offending item on the command line
+    std::size_t token_index = no_token;
+    // InvalidValue: the value which could not be converted
+    std::string_view value = {};
+    // InvalidNumOfValues: number of values required
+    int num_values = 0;
+    // ShortNameTaken, UnknownShortName
+    char short_name = '\0';
+};
+
+// called with the message of an error, see Parser::set_error_sink
+using ErrorSink = std::function<void(const std::string &message)>;
+
+// Errors of a parse (or of defining arguments). They are stored as codes with
+// views of names and values, and formatted only when asked for.
+class ParseResult
+{
+public:
+    // the list of errors is allocated with it
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    ParseResult() = default;
+    explicit ParseResult(allocator_type allocator) : error_list(allocator) {}
+
+    bool errors_occured() const { return not error_list.empty(); }
+    // help was printed instead of parsing
+    bool help_requested() const { return is_help_requested; }
+    // completions were printed instead of parsing
+    bool completion_requested() const { return is_completion_requested; }
+    std::span<const ParseError> errors() const { return error_list; }
+
+    static std::string message(const ParseError &error);
+
+    // calls sink(message) for every error
+    template <typename Sink>
+    void report(Sink &&sink) const
+    {
+        for (const ParseError &error : error_list)
+        {
+            sink(message(error));
+        }
+    }
+
+    std::string messages() const
+    {
+        std::string all_messages;
+        report([&](const std::string &msg) { all_messages += msg; });
+        return all_messages;
+    }
+
+private:
+    friend class Parser;
+    friend class Args;
+    template <typename... Arguments>
+    friend class schema;
+
+    std::pmr::vector<ParseError> error_list;
+    bool is_help_requested = false;
+    bool is_completion_requested = false;
+    // owns the names the errors refer to
+    std::shared_ptr<const NameIndex> names;
+};
+
+inline std::string ParseResult::message(const ParseError &error)
+{
+    std::string name(error.name);
+    switch (error.code)
+    {
+        case ErrorCode::ShortNameTaken:
+            return ErrorMessages::short_name_taken(error.short_name);
+        case ErrorCode::LongNameTaken:
+            return ErrorMessages::long_name_taken(name);
+        case ErrorCode::LongNameTooShort:
+            return ErrorMessages::long_name_too_short(name);
+        case ErrorCode::NameWithSpaces:
+            return ErrorMessages::name_with_spaces(name);
+        case ErrorCode::SpecifiedInvalidNumOfValues:
+            return ErrorMessages::specified_invalid_num_of_values(name);
+        case ErrorCode::SubcommandTaken:
+            return ErrorMessages::subcommand_taken(name);
+        case ErrorCode::InvalidSubcommandName:
+            return ErrorMessages::invalid_subcommand_name(name);
+        case ErrorCode::UnknownOption:
+            return ErrorMessages::unknown_option(name);
+        case ErrorCode::AmbiguousOption:
+            return ErrorMessages::ambiguous_option(name);
+        case ErrorCode::UnknownShortName:
+            return ErrorMessages::unknown_short_name(error.short_name, name);
+        case ErrorCode::OptionRequired:
+            return ErrorMessages::option_required(name);
+        case ErrorCode::InvalidNumOfValues:
+            return ErrorMessages::invalid_num_of_values(name, error.num_values);
+        case ErrorCode::InvalidValue:
+            return ErrorMessages::invalid_value(name, std::string(error.value));
+        case ErrorCode::PositionalRequired:
+            return ErrorMessages::positional_required(name);
+        case ErrorCode::ListRequired:
+            return ErrorMessages::list_required(name);
+        case ErrorCode::OptionNotGiven:
+            return ErrorMessages::option_not_given(name);
+        case ErrorCode::PositionalNotGiven:
+            return ErrorMessages::positional_not_given(name);
+    }
+    return {};
+}
+
+}  // namespace cppargs
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace cppargs {
+
+enum class ParsePhase
+{
+    // composing and printing help, only when requested
+    Help,
+    Tokenize,
+    Options,
+    VectorOptions,
+    Positionals,
+    Conversion
+};
+
+inline constexpr std::size_t num_parse_phases = 6;
+
+// What a single Parser::parse_args call spent its time on
+struct ParseStats
+{
+    std::array<std::chrono::nanoseconds, num_parse_phases> phase_times{};
+    std::size_t tokens_examined = 0;
+    // name index lookups
+    std::size_t matcher_invocations = 0;
+    // typed handle slots, or values stored in bound members
+    std::size_t values_converted = 0;
+    // difference of ParseObserver::allocation_count before and after parsing
+    std::size_t allocations = 0;
+
+    std::chrono::nanoseconds &time(ParsePhase phase)
+    {
+        return phase_times[static_cast<std::size_t>(phase)];
+    }
+    std::chrono::nanoseconds time(ParsePhase phase) const
+    {
+        return phase_times[static_cast<std::size_t>(phase)];
+    }
+};
+
+// Set with Parser::set_observer to receive the stats of every parse. Without
+// an observer nothing is measured.
+class ParseObserver
+{
+public:
+    virtual ~ParseObserver() = default;
+
+    virtual void on_parse(const ParseStats &stats) = 0;
+
+    // Number of heap allocations made by the process so far, if the
+    // application counts them (e.g. in a replaced operator new).
+    virtual std::size_t allocation_count() const { return 0; }
+};
+
+}  // namespace cppargs
@@ -1,485 +1,1835 @@
 #include "Parser.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+
+#ifdef CPPARGS_NO_IOSTREAM
+#include <cstdio>
+#else
+#include <iostream>
+#endif
+
+#include "ParseStats.h"
+#include "Tokenizer.h"
+
 namespace cppargs {
 
-using ErrorMessages::print_error;
-using std::regex;
+using ErrorMessages::print_error;
+
+struct Parser::PrefixIndex
+{
+    // "--long" and "-s" names with their arguments, the values of names
+    std::vector<std::string> words;
+    std::vector<ArgumentId> ids;
+    Trie names;
+    // values are indices of subcommands
+    Trie subcommand_names;
+};
+
+struct Parser::SharedState
+{
+    std::mutex help_mutex;
+    // without the program name, which goes at program_name_position
+    std::string help;
+    std::size_t program_name_position = 0;
+    bool is_help_composed = false;
+
+    // Built under the mutex by the first lookup. Once published, parses read
+    // it through the atomic pointer without locking.
+    std::mutex completion_mutex;
+    std::unique_ptr<PrefixIndex> completion;
+    std::atomic<const PrefixIndex *> built_completion = nullptr;
+
+    std::atomic<bool> has_last_parse_failed = false;
+};
+
+struct Parser::Subcommand
+{
+    std::string name;
+    std::string description;
+    SubcommandBuilder build;
+
+    // built by the first parse that selects it
+    mutable std::once_flag is_built;
+    mutable std::unique_ptr<Parser> parser;
+};
+
+// the names of the definitions, for the tokenizer
+struct Parser::NameLookup
+{
+    const Parser &parser;
+    std::size_t matcher_invocations = 0;
+
+    std::optional<tokenizer::NameMatch<ArgumentId>> match(
+        const ArgumentId *id) const
+    {
+        if (id == nullptr or id->kind == ArgumentKind::Positional)
+        {
+            return std::nullopt;
+        }
+        int num_values = id->kind == ArgumentKind::Flag
+                             ? 0
+                             : parser.definition(*id).num_values;
+        return tokenizer::NameMatch<ArgumentId>{*id, num_values};
+    }
+
+    // abbreviations of long names too, if allowed
+    template <typename Handler>
+    std::optional<tokenizer::NameMatch<ArgumentId>> find(
+        std::string_view name, std::size_t position, Handler &handler)
+    {
+        matcher_invocations++;
+        const ArgumentId *id = parser.find_argument(name);
+        if (id == nullptr and name.size() > 2 and
+            name.compare(0, 2, "--") == 0 and
+            parser.settings->are_abbreviations_allowed)
+        {
+            bool is_ambiguous = false;
+            id = parser.find_abbreviation(name, is_ambiguous);
+            if (is_ambiguous)
+            {
+                handler.error({.code = ErrorCode::AmbiguousOption,
+                               .name = name.substr(2),
+                               .token_index = position});
+            }
+        }
+        return match(id);
+    }
+
+    std::optional<tokenizer::NameMatch<ArgumentId>> find_short(
+        char short_name)
+    {
+        matcher_invocations++;
+        return match(parser.name_index->find_short(short_name));
+    }
+
+    std::string_view long_name(ArgumentId id) const
+    {
+        return parser.name_index->stable_name(parser.definition(id).long_name);
+    }
+};
+
+// stores the items found by tokenize in Args
+struct Parser::ArgsRecorder
+{
+    const Parser &parser;
+    Args &args;
+
+    bool stopped() const { return false; }
+    void error(const ParseError &error) { parser.report(args.result, error); }
+
+    void flag(ArgumentId id) { args.flags[id.index] = true; }
+
+    void option(ArgumentId id, std::size_t position, bool is_complete)
+    {
+        args.given_options.push_back(
+            {.id = id,
+             .position = static_cast<std::uint32_t>(position),
+             .first_value = static_cast<std::uint32_t>(args.values.size()),
+             .num_values = 0,
+             .is_complete = is_complete});
+    }
+
+    void value(std::string_view value)
+    {
+        args.values.push_back(value);
+        args.given_options.back().num_values++;
+    }
+
+    void positional(std::string_view item, std::size_t)
+    {
+        args.positionals.push_back(item);
+    }
+};
+
+// What a handler of tokenize found, by the index of the definitions. Small
+// enough to live on the stack for a couple of thousand definitions.
+struct Parser::GivenArguments
+{
+    std::array<std::byte, 512> buffer;
+    std::pmr::monotonic_buffer_resource memory{buffer.data(), buffer.size()};
+
+    std::pmr::vector<bool> flags;
+    std::pmr::vector<bool> options;
+    std::pmr::vector<bool> vec_options;
+    std::size_t num_positionals = 0;
+
+    explicit GivenArguments(const Definitions &definitions)
+        : flags(definitions.flags.size(), false, &memory),
+          options(definitions.options.size(), false, &memory),
+          vec_options(definitions.vec_options.size(), false, &memory)
+    {}
+
+    // true the first time the option is given
+    bool add_option(ArgumentId id)
+    {
+        std::pmr::vector<bool> &given =
+            id.kind == ArgumentKind::Option ? options : vec_options;
+        bool is_first = not given[id.index];
+        given[id.index] = true;
+        return is_first;
+    }
+};
+
+// Converts the items found by tokenize into the members bound to config.
+// Unless all errors are collected, only the first error of each check is
+// reported, as by parse_args: options, vector options and positionals. A
+// value that cannot be converted is then kept until the end and reported only
+// if nothing else failed.
+struct Parser::StructBinder
+{
+    const Parser &parser;
+    const std::type_info &config_type;
+    void *config;
+    ParseResult &result;
+    ParseStats *stats;
+    GivenArguments given;
+    // by ArgumentKind
+    std::array<bool, 4> has_failed{};
+    std::optional<ParseError> first_invalid_value;
+
+    // the option whose values come next, binding is nullptr if it is unbound
+    ArgumentId id;
+    std::size_t position = 0;
+    const Binding *binding = nullptr;
+    const Choices *choices = nullptr;
+    bool is_first_value = false;
+
+    StructBinder(const Parser &parser, const std::type_info &config_type,
+                 void *config, ParseResult &result, ParseStats *stats)
+        : parser(parser), config_type(config_type), config(config),
+          result(result), stats(stats), given(*parser.definitions)
+    {}
+
+    bool stopped() const { return false; }
+
+    void error(const ParseError &error)
+    {
+        if (parser.is_collecting_errors() or is_first_of_check(error))
+        {
+            parser.report(result, error);
+        }
+    }
+
+    // false for the errors after the first one of a check
+    bool is_first_of_check(const ParseError &error)
+    {
+        ArgumentKind kind = ArgumentKind::Positional;
+        if (error.code == ErrorCode::OptionRequired or
+            error.code == ErrorCode::InvalidNumOfValues)
+        {
+            kind = parser.name_index->find_long(error.name)->kind;
+        } else if (error.code != ErrorCode::PositionalRequired and
+                   error.code != ErrorCode::ListRequired)
+        {
+            return true;
+        }
+        bool is_first = not has_failed[static_cast<std::size_t>(kind)];
+        has_failed[static_cast<std::size_t>(kind)] = true;
+        return is_first;
+    }
+
+    void assign(const Binding &binding, ArgumentId argument_id,
+                std::string_view value, std::size_t position, bool is_first)
+    {
+        if (binding.assign(config, value, is_first))
+        {
+            if (stats != nullptr)
+            {
+                stats->values_converted++;
+            }
+            return;
+        }
+        ParseError invalid = parser.invalid_value(argument_id, value, position);
+        if (parser.is_collecting_errors())
+        {
+            parser.report(result, invalid);
+        } else if (not first_invalid_value)
+        {
+            first_invalid_value = invalid;
+        }
+    }
+
+    void flag(ArgumentId id) { given.flags[id.index] = true; }
+
+    void option(ArgumentId option_id, std::size_t position, bool is_complete)
+    {
+        is_first_value = given.add_option(option_id);
+        id = option_id;
+        this->position = position;
+        binding = parser.find_binding(id, config_type);
+        choices = parser.choices.empty() ? nullptr : parser.find_choices(id);
+        if (not is_complete)
+        {
+            error(parser.incomplete_option(id, position));
+        }
+    }
+
+    void value(std::string_view value)
+    {
+        if (choices != nullptr and choices->trie.find(value) == Trie::npos)
+        {
+            error(parser.invalid_value(id, value, position));
+        } else if (binding != nullptr)
+        {
+            assign(*binding, id, value, position, is_first_value);
+        }
+        is_first_value = false;
+    }
+
+    void positional(std::string_view item, std::size_t item_position)
+    {
+        std::size_t index = given.num_positionals++;
+        if (index >= parser.definitions->positionals.size())
+        {
+            return;
+        }
+        ArgumentId positional_id = {ArgumentKind::Positional, index};
+        if (const Binding *positional_binding =
+                parser.find_binding(positional_id, config_type))
+        {
+            assign(*positional_binding, positional_id, item, item_position,
+                   true);
+        }
+    }
+};
+
+// passes the items found by tokenize on to an ArgumentVisitor, until it stops
+struct Parser::VisitorCaller
+{
+    const Parser &parser;
+    ArgumentVisitor &visitor;
+    GivenArguments given;
+
+    ArgumentId id;
+    std::size_t position = 0;
+    const Choices *choices = nullptr;
+    bool is_stopped = false;
+
+    VisitorCaller(const Parser &parser, ArgumentVisitor &visitor)
+        : parser(parser), visitor(visitor), given(*parser.definitions)
+    {}
+
+    bool stopped() const { return is_stopped; }
+
+    void error(const ParseError &error)
+    {
+        is_stopped = is_stopped or not visitor.on_error(error);
+    }
+
+    void flag(ArgumentId flag_id)
+    {
+        given.flags[flag_id.index] = true;
+        is_stopped = is_stopped or not visitor.on_flag(flag_id);
+    }
+
+    void option(ArgumentId option_id, std::size_t position, bool is_complete)
+    {
+        given.add_option(option_id);
+        id = option_id;
+        this->position = position;
+        choices = parser.choices.empty() ? nullptr : parser.find_choices(id);
+        if (not is_complete)
+        {
+            error(parser.incomplete_option(id, position));
+        }
+    }
+
+    void value(std::string_view value)
+    {
+        if (choices != nullptr and choices->trie.find(value) == Trie::npos)
+        {
+            error(parser.invalid_value(id, value, position));
+            return;
+        }
+        is_stopped = is_stopped or not visitor.on_option(id, value);
+    }
+
+    void positional(std::string_view item, std::size_t)
+    {
+        is_stopped = is_stopped or
+                     not visitor.on_positional(given.num_positionals++, item);
+    }
+};
+
+namespace {
+
+// adds the time until the end of the scope to a phase, if measuring
+class PhaseTimer
+{
+public:
+    PhaseTimer(ParseStats *stats, ParsePhase phase) : stats(stats), phase(phase)
+    {
+        if (stats != nullptr)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer()
+    {
+        if (stats != nullptr)
+        {
+            stats->time(phase) += std::chrono::steady_clock::now() - start;
+        }
+    }
+
+private:
+    ParseStats *stats;
+    ParsePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+struct HelpRow
+{
+    std::string usage;
+    std::string_view description;
+};
+
+// "-s, --long VALUES", short name column left blank if there is none
+std::string argument_usage(const CmdLineArgumentBase &argument,
+                           std::string_view values)
+{
+    std::string usage = argument.short_name.empty()
+                            ? "    "
+                            : "-" + argument.short_name + ", ";
+    usage += "--";
+    usage += argument.long_name;
+    usage += values;
+    return usage;
+}
+
+// descriptions start two spaces after the widest usage
+void append_help_section(std::string &help, std::string_view title,
+                         const std::vector<HelpRow> &rows, std::size_t width)
+{
+    help += "\n";
+    help += title;
+    help += "\n";
+    for (const HelpRow &row : rows)
+    {
+        help += row.usage;
+        help.append(width + 2 - row.usage.size(), ' ');
+        help += row.description;
+        help += "\n";
+    }
+}
+
+// hidden first argument of completion requests
+constexpr std::string_view completion_command = "__complete";
+
+bool is_failed(const Args &args)
+{
+    const ParseResult &result = args.parse_result();
+    return result.errors_occured() or result.help_requested() or
+           result.completion_requested();
+}
+
+// position of a positional on the command line, it views the whole item
+std::size_t item_position(const CmdLine &cmd_line, std::string_view item)
+{
+    for (std::size_t i = 1; i < cmd_line.size(); i++)
+    {
+        if (cmd_line[i].data() == item.data())
+        {
+            return i;
+        }
+    }
+    return ParseError::no_token;
+}
+
+void write_stdout(std::string_view text)
+{
+#ifdef CPPARGS_NO_IOSTREAM
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    std::fflush(stdout);
+#else
+    std::cout.write(text.data(), text.size());
+    std::cout.flush();
+#endif
+}
+
+// for names of shell functions
+std::string identifier(std::string_view name)
+{
+    std::string id(name);
+    for (char &c : id)
+    {
+        if (not utils::is_letter(c) and (c < '0' or c > '9'))
+        {
+            c = '_';
+        }
+    }
+    return id;
+}
+
+}  // namespace
+
+Parser::Parser()
+    : definitions(std::make_shared<Definitions>()),
+      name_index(std::make_shared<NameIndex>()),
+      own_settings(std::make_unique<Settings>()),
+      settings(own_settings.get()),
+      shared_state(std::make_unique<SharedState>())
+{
+    own_settings->error_sink = std::make_shared<const ErrorSink>(
+        [](const std::string &message) { print_error(message); });
+    definitions->flags.emplace_back("h", "help", "print this help message");
+    index_argument('h', "help", {ArgumentKind::Flag, 0});
+}
+
+Parser::~Parser() = default;
+Parser::Parser(Parser &&) noexcept = default;
+Parser &Parser::operator=(Parser &&) noexcept = default;
+
+bool Parser::errors_occured() const
+{
+    return definition_result.errors_occured() or
+           shared_state->has_last_parse_failed;
+}
+
+Definitions &Parser::mutable_definitions()
+{
+    if (definitions.use_count() > 1)
+    {
+        definitions = std::make_shared<Definitions>(*definitions);
+    }
+    return *definitions;
+}
+
+// Errors of definitions are the parser's own, they are moved on to the copy
+// instead of keeping the old index alive.
+NameIndex &Parser::mutable_name_index()
+{
+    long num_own_references = definition_result.names == name_index ? 2 : 1;
+    if (name_index.use_count() > num_own_references)
+    {
+        name_index = std::make_shared<NameIndex>(*name_index);
+        if (definition_result.names)
+        {
+            for (ParseError &error : definition_result.error_list)
+            {
+                error.name = name_index->stable_name(error.name);
+                error.value = name_index->stable_name(error.value);
+            }
+            definition_result.names = name_index;
+        }
+    }
+    return *name_index;
+}
+
+void Parser::definitions_changed()
+{
+    shared_state->is_help_composed = false;
+    shared_state->built_completion = nullptr;
+    shared_state->completion.reset();
+}
+
+void Parser::index_argument(char short_name, const std::string &long_name,
+                            ArgumentId id)
+{
+    mutable_name_index().add(short_name, long_name, id);
+    definitions_changed();
+}
+
+void Parser::reserve_names(std::size_t num_names)
+{
+    mutable_name_index().reserve(
+        definitions->flags.size() + definitions->options.size() +
+        definitions->vec_options.size() + definitions->positionals.size() +
+        num_names);
+}
+
+void Parser::report(ParseResult &result, const ParseError &error) const
+{
+    result.error_list.push_back(error);
+    result.names = name_index;
+    if (*settings->error_sink)
+    {
+        (*settings->error_sink)(ParseResult::message(error));
+    }
+}
+
+// Keeps the capacity of the containers, for the next parse into args. Typed
+// values are kept too, conversion overwrites them.
+void Parser::clear(Args &args)
+{
+    args.program_name.clear();
+    args.definitions.reset();
+    args.flags.clear();
+    args.given_options.clear();
+    args.values.clear();
+    args.positionals.clear();
+}
+
+// only the index and the errors are kept
+void Parser::fail(Args &args)
+{
+    clear(args);
+    args.typed_values.clear();
+}
+
+const ArgumentId *Parser::find_argument(std::string_view cmd_line_item) const
+{
+    if (cmd_line_item.size() > 2 and cmd_line_item.compare(0, 2, "--") == 0)
+    {
+        return name_index->find_long(cmd_line_item.substr(2));
+    }
+
+    if (cmd_line_item.size() == 2 and cmd_line_item[0] == '-')
+    {
+        return name_index->find_short(cmd_line_item[1]);
+    }
+    return nullptr;
+}
+
+bool Parser::is_name_valid(char short_name, const std::string &long_name)
+{
+    if (short_name != '\0' and name_index->find_short(short_name) != nullptr)
+    {
+        report(definition_result,
+               {.code = ErrorCode::ShortNameTaken,
+                .name = mutable_name_index().intern(long_name),
+                .short_name = short_name});
+        return false;
+    }
+
+    return is_name_valid(long_name);
+}
+
+bool Parser::is_name_valid(const std::string &long_name)
+{
+    if (name_index->contains(long_name))
+    {
+        report(definition_result,
+               {.code = ErrorCode::LongNameTaken,
+                .name = mutable_name_index().intern(long_name)});
+        return false;
+    }
+
+    if (long_name.find(' ') != std::string::npos)
+    {
+        report(definition_result,
+               {.code = ErrorCode::NameWithSpaces,
+                .name = mutable_name_index().intern(long_name)});
+        return false;
+    }
+
+    if (long_name.size() < 2)
+    {
+        report(definition_result,
+               {.code = ErrorCode::LongNameTooShort,
+                .name = mutable_name_index().intern(long_name)});
+        return false;
+    }
+
+    return true;
+}
+
+FlagHandle Parser::add_flag(char short_name, std::string long_name,
+                            std::string description)
+{
+    if (not is_name_valid(short_name, long_name))
+    {
+        return {};
+    }
+
+    std::size_t index = definitions->flags.size();
+    index_argument(short_name, long_name, {ArgumentKind::Flag, index});
+    mutable_definitions().flags.emplace_back(
+        utils::short_name_string(short_name), std::move(long_name),
+        std::move(description));
+    return {index};
+}
+
+FlagHandle Parser::add_flag(std::string long_name, std::string description)
+{
+    return add_flag('\0', std::move(long_name), std::move(description));
+}
+
+void Parser::add_option(char short_name, std::string long_name,
+                        std::string description, bool required,
+                        std::string default_value)
+{
+    if (is_name_valid(short_name, long_name))
+    {
+        Definitions &defined = mutable_definitions();
+        std::size_t index = defined.options.size();
+        index_argument(short_name, long_name, {ArgumentKind::Option, index});
+        defined.options.emplace_back(utils::short_name_string(short_name),
+                                     std::move(long_name),
+                                     std::move(description), required,
+                                     std::move(default_value));
+        if (required)
+        {
+            defined.required_options.push_back(index);
+        }
+    }
+}
+
+void Parser::add_option(std::string long_name, std::string description,
+                        bool required, std::string default_value)
+{
+    add_option('\0', std::move(long_name), std::move(description), required,
+               std::move(default_value));
+}
+
+void Parser::add_vec_option(char short_name, std::string long_name,
+                            std::string description, int num_values,
+                            bool requred)
+{
+    if (num_values < 2)
+    {
+        report(definition_result,
+               {.code = ErrorCode::SpecifiedInvalidNumOfValues,
+                .name = mutable_name_index().intern(long_name),
+                .num_values = num_values});
+        return;
+    }
+
+    if (is_name_valid(short_name, long_name))
+    {
+        Definitions &defined = mutable_definitions();
+        std::size_t index = defined.vec_options.size();
+        index_argument(short_name, long_name,
+                       {ArgumentKind::VectorOption, index});
+        defined.vec_options.emplace_back(
+            utils::short_name_string(short_name), std::move(long_name),
+            std::move(description), num_values, requred);
+        if (requred)
+        {
+            defined.required_vec_options.push_back(index);
+        }
+    }
+}
+
+void Parser::add_vec_option(std::string long_name, std::string description,
+                            int num_values, bool requred)
+{
+    add_vec_option('\0', std::move(long_name), std::move(description),
+                   num_values, requred);
+}
+
+void Parser::add_positional(std::string long_name, std::string description)
+{
+    if (is_name_valid(long_name))
+    {
+        index_argument('\0', long_name,
+                       {ArgumentKind::Positional,
+                        definitions->positionals.size()});
+        mutable_definitions().positionals.emplace_back(std::move(long_name),
+                                                       std::move(description));
+    }
+}
+
+void Parser::add_flags(std::span<const FlagSpec> specs)
+{
+    reserve_names(specs.size());
+    Definitions &defined = mutable_definitions();
+    defined.flags.reserve(defined.flags.size() + specs.size());
+
+    for (const FlagSpec &spec : specs)
+    {
+        add_flag(spec.short_name, std::string(spec.long_name),
+                 std::string(spec.description));
+    }
+}
+
+void Parser::add_options(std::span<const OptionSpec> specs)
+{
+    std::size_t num_options = std::count_if(
+        specs.begin(), specs.end(),
+        [](const OptionSpec &spec) { return spec.num_values == 1; });
+
+    reserve_names(specs.size());
+    Definitions &defined = mutable_definitions();
+    defined.options.reserve(defined.options.size() + num_options);
+    defined.vec_options.reserve(defined.vec_options.size() + specs.size() -
+                                num_options);
+
+    for (const OptionSpec &spec : specs)
+    {
+        if (spec.num_values == 1)
+        {
+            add_option(spec.short_name, std::string(spec.long_name),
+                       std::string(spec.description), spec.required,
+                       std::string(spec.default_value));
+        } else
+        {
+            add_vec_option(spec.short_name, std::string(spec.long_name),
+                           std::string(spec.description), spec.num_values,
+                           spec.required);
+        }
+    }
+}
+
+std::size_t Parser::add_typed_argument(ArgumentId id, ConvertFunction convert)
+{
+    typed_arguments.push_back({id, convert});
+    return typed_arguments.size() - 1;
+}
+
+void Parser::add_binding(ArgumentId id, const std::type_info &config_type,
+                         AssignFunction assign)
+{
+    std::vector<std::size_t> &indices =
+        binding_indices[static_cast<std::size_t>(id.kind)];
+    if (indices.size() <= id.index)
+    {
+        indices.resize(id.index + 1, no_binding);
+    }
+    indices[id.index] = bindings.size();
+    bindings.push_back({id, &config_type, std::move(assign)});
+}
+
+const Parser::Binding *Parser::find_binding(
+    ArgumentId id, const std::type_info &config_type) const
+{
+    const std::vector<std::size_t> &indices =
+        binding_indices[static_cast<std::size_t>(id.kind)];
+    if (id.index >= indices.size() or indices[id.index] == no_binding)
+    {
+        return nullptr;
+    }
+    const Binding &binding = bindings[indices[id.index]];
+    return *binding.config_type == config_type ? &binding : nullptr;
+}
+
+const CmdLineArgumentBase &Parser::definition(ArgumentId id) const
+{
+    switch (id.kind)
+    {
+        case ArgumentKind::Flag:
+            return definitions->flags[id.index];
+        case ArgumentKind::Option:
+            return definitions->options[id.index];
+        case ArgumentKind::VectorOption:
+            return definitions->vec_options[id.index];
+        case ArgumentKind::Positional:
+            break;
+    }
+    return definitions->positionals[id.index];
+}
+
+void Parser::add_subcommand(std::string name, std::string description,
+                            SubcommandBuilder build)
+{
+    if (name.empty() or name[0] == '-' or name.find(' ') != std::string::npos)
+    {
+        report(definition_result, {.code = ErrorCode::InvalidSubcommandName,
+                                   .name = mutable_name_index().intern(name)});
+        return;
+    }
+    if (subcommand_index.contains(name))
+    {
+        report(definition_result, {.code = ErrorCode::SubcommandTaken,
+                                   .name = mutable_name_index().intern(name)});
+        return;
+    }
+
+    subcommand_index.emplace(name, subcommands.size());
+    subcommands.push_back(std::make_unique<Subcommand>());
+    Subcommand &subcommand = *subcommands.back();
+    subcommand.name = std::move(name);
+    subcommand.description = std::move(description);
+    subcommand.build = std::move(build);
+    definitions_changed();
+}
+
+const Parser::Subcommand *Parser::find_subcommand(std::string_view name) const
+{
+    if (subcommands.empty())
+    {
+        return nullptr;
+    }
+    auto it = subcommand_index.find(name);
+    return it != subcommand_index.end() ? subcommands[it->second].get()
+                                        : nullptr;
+}
+
+const Parser &Parser::subcommand_parser(const Subcommand &subcommand) const
+{
+    std::call_once(subcommand.is_built, [&] {
+        auto parser = std::make_unique<Parser>();
+        parser->settings = settings;
+        parser->add_description(subcommand.description);
+        if (subcommand.build)
+        {
+            subcommand.build(*parser);
+        }
+        subcommand.parser = std::move(parser);
+    });
+    return *subcommand.parser;
+}
+
+void Parser::parse_subcommand(const Subcommand &subcommand,
+                              const CmdLine &cmd_line, Args &args) const
+{
+    args.program_name += ' ';
+    args.program_name += subcommand.name;
+    subcommand_parser(subcommand).parse_arguments(cmd_line.tail(), args);
+    if (args.subcommand_name.empty())
+    {
+        args.subcommand_name = cmd_line[1];
+    }
+}
+
+void Parser::add_positional_list(std::string long_name, std::string description)
+{
+    mutable_name_index().intern(long_name);
+    positional_list.long_name = std::move(long_name);
+    positional_list.description = std::move(description);
+    positional_list.required = true;
+    definitions_changed();
+}
+
+Args Parser::parse_args(int argc, char *argv[]) const
+{
+    Args args;
+    parse_and_record(CmdLine(argc, argv), args);
+    return args;
+}
+
+Args Parser::parse_args(const std::vector<std::string> &cmd_line) const
+{
+    Args args;
+    parse_and_record(CmdLine(cmd_line), args);
+    return args;
+}
+
+Args Parser::parse_args(int argc, char *argv[],
+                        std::pmr::memory_resource *memory) const
+{
+    Args args(memory);
+    parse_and_record(CmdLine(argc, argv), args);
+    return args;
+}
+
+Args Parser::parse_args(const std::vector<std::string> &cmd_line,
+                        std::pmr::memory_resource *memory) const
+{
+    Args args(memory);
+    parse_and_record(CmdLine(cmd_line), args);
+    return args;
+}
+
+void Parser::parse_args(int argc, char *argv[], Args &args) const
+{
+    parse_and_record(CmdLine(argc, argv), args);
+}
+
+void Parser::parse_args(const std::vector<std::string> &cmd_line,
+                        Args &args) const
+{
+    parse_and_record(CmdLine(cmd_line), args);
+}
+
+ParseResult Parser::parse_into(const CmdLine &cmd_line,
+                               const std::type_info &config_type,
+                               void *config) const
+{
+    ParseResult result;
+    observe([&](ParseStats *stats) {
+        bind_arguments(cmd_line, config_type, config, stats, result);
+    });
+    shared_state->has_last_parse_failed =
+        result.errors_occured() or result.is_help_requested;
+    return result;
+}
+
+void Parser::bind_arguments(const CmdLine &cmd_line,
+                            const std::type_info &config_type, void *config,
+                            ParseStats *stats, ParseResult &result) const
+{
+    if (definition_result.errors_occured())
+    {
+        result = definition_result;
+        return;
+    }
+    if (cmd_line.empty())
+    {
+        return;
+    }
+
+    StructBinder binder(*this, config_type, config, result, stats);
+    {
+        PhaseTimer timer(stats, ParsePhase::Tokenize);
+        tokenize(cmd_line, binder, stats);
+    }
+
+    if (binder.given.flags[0])
+    {
+        PhaseTimer timer(stats, ParsePhase::Help);
+        print_help(cmd_line[0]);
+        result.is_help_requested = true;
+        return;
+    }
+    {
+        PhaseTimer timer(stats, ParsePhase::Options);
+        report_missing(binder.given, binder);
+    }
+    if (binder.first_invalid_value and not result.errors_occured())
+    {
+        report(result, *binder.first_invalid_value);
+    }
+
+    // what was not on the command line
+    PhaseTimer timer(stats, ParsePhase::Conversion);
+    for (const Binding &binding : bindings)
+    {
+        if (*binding.config_type != config_type)
+        {
+            continue;
+        }
+        if (binding.id.kind == ArgumentKind::Flag)
+        {
+            binding.assign(config,
+                           binder.given.flags[binding.id.index] ? "1" : "0",
+                           true);
+        } else if (binding.id.kind == ArgumentKind::Option and
+                   not binder.given.options[binding.id.index])
+        {
+            const std::string &default_value =
+                definitions->options[binding.id.index].get_default_value();
+            if (not default_value.empty())
+            {
+                binding.assign(config, default_value, true);
+            }
+        }
+    }
+}
 
-Parser::Parser() : is_parsing_successful(true)
+bool Parser::visit(int argc, char *argv[], ArgumentVisitor &visitor) const
 {
-    user_defined_args.flags.emplace_back("h", "help",
-                                         "print this help message");
+    return visit(CmdLine(argc, argv), visitor);
 }
 
-bool Parser::is_name_valid(char short_name, const std::string &long_name)
+bool Parser::visit(const std::vector<std::string> &cmd_line,
+                   ArgumentVisitor &visitor) const
 {
-    if (user_defined_args.is_defined(std::string(1, short_name)))
-    {
-        print_error(ErrorMessages::short_name_taken(short_name));
-        parsing_failed();
-        return false;
-    }
-
-    return is_name_valid(long_name);
+    return visit(CmdLine(cmd_line), visitor);
 }
 
-bool Parser::is_name_valid(const std::string &long_name)
+bool Parser::visit(const CmdLine &cmd_line, ArgumentVisitor &visitor) const
 {
-    if (user_defined_args.is_defined(long_name))
+    VisitorCaller caller(*this, visitor);
+    for (const ParseError &error : definition_result.errors())
     {
-        print_error(ErrorMessages::long_name_taken(long_name));
-        parsing_failed();
-        return false;
+        caller.error(error);
     }
-
-    if (long_name.find(' ') != std::string::npos)
+    if (definition_result.errors_occured() or cmd_line.empty())
     {
-        print_error(ErrorMessages::name_with_spaces(long_name));
-        parsing_failed();
         return false;
     }
 
-    if (long_name.size() < 2)
+    tokenize(cmd_line, caller, nullptr);
+    if (not caller.stopped())
     {
-        print_error(ErrorMessages::long_name_too_short(long_name));
-        parsing_failed();
-        return false;
+        report_missing(caller.given, caller);
     }
-
-    return true;
+    return not caller.stopped();
 }
 
-void Parser::add_flag(char short_name, std::string long_name,
-                      std::string description)
+// required options and positionals that were not given
+template <typename Handler>
+void Parser::report_missing(const GivenArguments &given,
+                            Handler &handler) const
 {
-    if (is_name_valid(short_name, long_name))
+    for (std::size_t index : definitions->required_options)
+    {
+        if (not given.options[index])
+        {
+            handler.error({.code = ErrorCode::OptionRequired,
+                           .name = name_index->stable_name(
+                               definitions->options[index].long_name)});
+        }
+    }
+    for (std::size_t index : definitions->required_vec_options)
     {
-        user_defined_args.flags.emplace_back(
-            Flag(std::string(1, short_name), long_name, description));
+        if (not given.vec_options[index])
+        {
+            handler.error({.code = ErrorCode::OptionRequired,
+                           .name = name_index->stable_name(
+                               definitions->vec_options[index].long_name)});
+        }
     }
+    report_missing_positionals(given.num_positionals, handler);
 }
 
-void Parser::add_flag(std::string long_name, std::string description)
+// the first positional not given, and the list; the list only if all errors
+// are collected or the positionals are complete
+template <typename Handler>
+void Parser::report_missing_positionals(std::size_t num_positionals,
+                                        Handler &handler) const
 {
-    add_flag('\0', long_name, description);
+    if (num_positionals < definitions->positionals.size())
+    {
+        handler.error({.code = ErrorCode::PositionalRequired,
+                       .name = name_index->stable_name(
+                           definitions->positionals[num_positionals]
+                               .long_name)});
+        if (not is_collecting_errors())
+        {
+            return;
+        }
+    }
+    if (positional_list.required and
+        num_positionals <= definitions->positionals.size() + 1)
+    {
+        handler.error({.code = ErrorCode::ListRequired,
+                       .name = name_index->stable_name(
+                           positional_list.long_name)});
+    }
 }
 
-void Parser::add_option(char short_name, std::string long_name,
-                        std::string description, bool required,
-                        std::string default_value)
+ParseError Parser::incomplete_option(ArgumentId id, std::size_t position) const
 {
-    if (is_name_valid(short_name, long_name))
-    {
-        user_defined_args.options.emplace_back(std::string(1, short_name),
-                                               long_name, description, required,
-                                               default_value);
-    }
+    const CmdLineArgumentBase &option = definition(id);
+    return {.code = ErrorCode::InvalidNumOfValues,
+            .name = name_index->stable_name(option.long_name),
+            .token_index = position,
+            .num_values = option.num_values};
 }
 
-void Parser::add_option(std::string long_name, std::string description,
-                        bool required, std::string default_value)
+ParseError Parser::invalid_value(ArgumentId id, std::string_view value,
+                                 std::size_t position) const
 {
-    add_option('\0', long_name, description, required, default_value);
+    return {.code = ErrorCode::InvalidValue,
+            .name = name_index->stable_name(definition(id).long_name),
+            .token_index = position,
+            .value = value};
 }
 
-void Parser::add_vec_option(char short_name, std::string long_name,
-                            std::string description, int num_values,
-                            bool requred)
+std::vector<Args> Parser::parse_batch(
+    std::span<const std::vector<std::string_view>> cmd_lines,
+    unsigned num_threads) const
 {
-    if (num_values < 2)
+    // threads take chunks of command lines until there are none left, so the
+    // ones that get short command lines do more of them
+    constexpr std::size_t chunk_size = 64;
+    std::size_t num_chunks = (cmd_lines.size() + chunk_size - 1) / chunk_size;
+    std::atomic<std::size_t> next_chunk = 0;
+    std::atomic<bool> has_any_failed = false;
+
+    std::vector<Args> results(cmd_lines.size());
+    auto parse_chunks = [&] {
+        bool has_failed = false;
+        for (std::size_t chunk = next_chunk++; chunk < num_chunks;
+             chunk = next_chunk++)
+        {
+            std::size_t end =
+                std::min(cmd_lines.size(), (chunk + 1) * chunk_size);
+            for (std::size_t i = chunk * chunk_size; i < end; i++)
+            {
+                parse(CmdLine(cmd_lines[i]), results[i]);
+                has_failed = has_failed or is_failed(results[i]);
+            }
+        }
+        if (has_failed)
+        {
+            has_any_failed = true;
+        }
+    };
+
+    if (num_threads == 0)
     {
-        print_error(ErrorMessages::specified_invalid_num_of_values(long_name));
-        parsing_failed();
-        return;
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
     }
+    num_threads = std::min<std::size_t>(num_threads, num_chunks);
 
-    if (is_name_valid(short_name, long_name))
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < num_threads; t++)
     {
-        user_defined_args.vec_options.emplace_back(
-            VectorOption(std::string(1, short_name), long_name, description,
-                         num_values, requred));
+        workers.emplace_back(parse_chunks);
     }
+    parse_chunks();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    shared_state->has_last_parse_failed = has_any_failed.load();
+    return results;
 }
 
-void Parser::add_vec_option(std::string long_name, std::string description,
-                            int num_values, bool requred)
+void Parser::parse_and_record(const CmdLine &cmd_line, Args &args) const
 {
-    add_vec_option('\0', long_name, description, num_values, requred);
+    parse(cmd_line, args);
+    shared_state->has_last_parse_failed = is_failed(args);
 }
 
-void Parser::add_positional(std::string long_name, std::string description)
+void Parser::parse(const CmdLine &cmd_line, Args &args) const
 {
-    if (is_name_valid(long_name))
+    clear(args);
+    args.index.reset();
+    args.result.error_list.clear();
+    args.result.is_help_requested = false;
+    args.result.is_completion_requested = false;
+    args.result.names.reset();
+    args.subcommand_name = {};
+    args.error_sink = settings->error_sink;
+
+    if (cmd_line.size() >= 3 and cmd_line[1] == completion_command)
+    {
+        fail(args);
+        print_completions(cmd_line, args);
+        return;
+    }
+    if (not cmd_line.empty())
     {
-        Positional pos(long_name, "");
-        pos.description = description;
-        user_defined_args.positionals.push_back(pos);
+        args.program_name.assign(cmd_line[0]);
     }
+    parse_arguments(cmd_line, args);
 }
 
-void Parser::add_positional_list(std::string long_name, std::string description)
+void Parser::parse_arguments(const CmdLine &cmd_line, Args &args) const
 {
-    positional_list.long_name = long_name;
-    positional_list.description = description;
-    positional_list.required = true;
+    const Subcommand *subcommand =
+        cmd_line.size() >= 2 ? find_subcommand(cmd_line[1]) : nullptr;
+    if (subcommand != nullptr)
+    {
+        parse_subcommand(*subcommand, cmd_line, args);
+        return;
+    }
+
+    observe([&](ParseStats *stats) { parse_arguments(cmd_line, stats, args); });
 }
 
-Args Parser::parse_args(int argc, char *argv[])
+template <typename Parse>
+void Parser::observe(Parse &&parse) const
 {
-    return parse_args(std::vector<std::string>(argv, argv + argc));
+    ParseObserver *observer = settings->observer;
+    if (observer == nullptr)
+    {
+        parse(nullptr);
+        return;
+    }
+
+    ParseStats stats;
+    std::size_t allocation_count = observer->allocation_count();
+    parse(&stats);
+    stats.allocations = observer->allocation_count() - allocation_count;
+    observer->on_parse(stats);
 }
 
-Args Parser::parse_args(const std::vector<std::string> &cmd_line)
+// args.program_name is set, the rest of args is empty
+void Parser::parse_arguments(const CmdLine &cmd_line, ParseStats *stats,
+                             Args &args) const
 {
-    if (errors_occured())
+    args.index = name_index;
+    if (definition_result.errors_occured())
     {
-        return {};
+        args.result = definition_result;
+        fail(args);
+        return;
+    }
+    if (cmd_line.empty())
+    {
+        fail(args);
+        args.index.reset();
+        return;
     }
 
-    Args args;
-    init_occupied_positions(cmd_line);
-
-    program_name = cmd_line[0];
-    args.program_name = cmd_line[0];
-    // TODO: extract help to class
-    compose_help();
+    args.definitions = definitions;
 
-    args.flags = parse_flags(cmd_line);
+    {
+        PhaseTimer timer(stats, ParsePhase::Tokenize);
+        args.flags.assign(definitions->flags.size(), false);
+        ArgsRecorder recorder{*this, args};
+        tokenize(cmd_line, recorder, stats);
+        args.sort_given_options();
+    }
 
     if (args["help"])
     {
-        print_help();
+        PhaseTimer timer(stats, ParsePhase::Help);
+        print_help(args.program_name);
         // TODO: think about it... If user wants to print help, then iside a
         // program you have to check errors_occured() state... Is it an error?
-        parsing_failed();
-        return {};
+        fail(args);
+        args.index.reset();
+        args.result.is_help_requested = true;
+        return;
     }
 
-    args.options = parse_options(cmd_line, user_defined_args.options);
-    args.vec_options =
-        parse_options(cmd_line, user_defined_args.vec_options);
-    args.positionals = parse_positional(cmd_line);  // has to be last!!
+    {
+        PhaseTimer timer(stats, ParsePhase::Options);
+        are_options_valid(definitions->options, definitions->required_options,
+                          args.occurrences(ArgumentKind::Option), args.result);
+        are_choices_valid(args, args.result);
+    }
+    {
+        PhaseTimer timer(stats, ParsePhase::VectorOptions);
+        are_options_valid(definitions->vec_options,
+                          definitions->required_vec_options,
+                          args.occurrences(ArgumentKind::VectorOption),
+                          args.result);
+    }
 
-    // TODO: extract to func
-    if (positional_list.required &&
-        num_positionals <= user_defined_args.positionals.size() + 1)
     {
-        print_error(ErrorMessages::list_required(positional_list.long_name));
-        parsing_failed();
-        return {};
+        PhaseTimer timer(stats, ParsePhase::Positionals);
+        ArgsRecorder recorder{*this, args};
+        report_missing_positionals(args.positionals.size(), recorder);
     }
 
-    if (errors_occured())
+    // with all errors collected, invalid typed values are reported as well
+    if (args.result.errors_occured() and not is_collecting_errors())
     {
-        return {};
+        fail(args);
+        return;
     }
 
-    return args;
+    PhaseTimer timer(stats, ParsePhase::Conversion);
+    if (not convert_typed_values(cmd_line, args, stats))
+    {
+        fail(args);
+    }
 }
 
-void Parser::init_occupied_positions(std::vector<std::string> cmd_line)
+bool Parser::convert_typed_values(const CmdLine &cmd_line, Args &args,
+                                  ParseStats *stats) const
 {
-    occupied_positions.assign(cmd_line.size(), false);
+    args.typed_values.resize(typed_arguments.size());
+    for (std::size_t slot = 0; slot < typed_arguments.size(); slot++)
+    {
+        const TypedArgument &argument = typed_arguments[slot];
+        std::string_view value;
+        if (not argument.convert(args, argument.id.index,
+                                 args.typed_values[slot], value))
+        {
+            std::size_t position =
+                argument.id.kind == ArgumentKind::Positional
+                    ? item_position(cmd_line, value)
+                    : args.option_position(argument.id, value);
+            report(args.result, invalid_value(argument.id, value, position));
+            if (not is_collecting_errors())
+            {
+                return false;
+            }
+            continue;
+        }
+        if (stats != nullptr)
+        {
+            stats->values_converted++;
+        }
+    }
+    return not args.result.errors_occured();
 }
 
-std::vector<Flag> Parser::parse_flags(const std::vector<std::string> &cmd_line)
+template <typename Handler>
+void Parser::tokenize(const CmdLine &cmd_line, Handler &handler,
+                      ParseStats *stats) const
 {
-    std::vector<Flag> flags;
+    NameLookup names{*this};
+    tokenizer::tokenize(cmd_line, names, handler);
 
-    for (Flag defined_flag : user_defined_args.flags)
+    if (stats != nullptr)
     {
-        Flag flag = defined_flag;
-        flag.status = false;
+        stats->tokens_examined += cmd_line.size() - 1;
+        stats->matcher_invocations += names.matcher_invocations;
+    }
+}
 
-        for (int i = 1; i < cmd_line.size(); i++)
-        {
-            if (flag.is_cmd_line_item(cmd_line[i]))
-            {
-                flag.status = true;
-                occupied_positions.at(i) = true;
-            }
-        }
-        flags.push_back(flag);
+// nullptr if no long name starts with the abbreviation, or several do
+const ArgumentId *Parser::find_abbreviation(std::string_view cmd_line_item,
+                                            bool &is_ambiguous) const
+{
+    const PrefixIndex &index = prefix_index();
+    std::size_t word = index.names.find_unique(cmd_line_item);
+    if (word != Trie::npos)
+    {
+        return &index.ids[word];
     }
-    return flags;
+    is_ambiguous = index.names.num_words_with_prefix(cmd_line_item) > 1;
+    return nullptr;
 }
 
+// Errors are reported in the order of definitions. The first one ends the
+// checks, unless all errors are collected. required and given are sorted by
+// index.
 template <typename T>
-std::vector<T> Parser::parse_options(const std::vector<std::string> &cmd_line,
-                                     const std::vector<T> &user_defined_options)
+bool Parser::are_options_valid(const std::vector<T> &options,
+                               std::span<const std::size_t> required,
+                               std::span<const Args::GivenOption> given,
+                               ParseResult &result) const
 {
-    std::vector<T> options;
-
-    for (T defined_option : user_defined_options)
+    constexpr std::size_t none = static_cast<std::size_t>(-1);
+    bool are_valid = true;
+    auto next_required = required.begin();
+    auto next_given = given.begin();
+    while (next_required != required.end() or next_given != given.end())
     {
-        T option = defined_option;
-        bool found = false;
-        bool enough_values_given = false;
+        std::size_t index = std::min(
+            next_required != required.end() ? *next_required : none,
+            next_given != given.end() ? next_given->id.index : none);
 
-        extract_option(cmd_line, option, found, enough_values_given);
+        bool is_required = next_required != required.end() and
+                           *next_required == index;
+        if (is_required)
+        {
+            ++next_required;
+        }
+        bool is_given = false;
+        std::size_t missing_values_position = ParseError::no_token;
+        for (; next_given != given.end() and next_given->id.index == index;
+             ++next_given)
+        {
+            is_given = true;
+            if (not next_given->is_complete and
+                missing_values_position == ParseError::no_token)
+            {
+                missing_values_position = next_given->position;
+            }
+        }
 
-        if (option.required && not found)
+        const T &option = options[index];
+        if (is_required and not is_given)
         {
-            print_error(ErrorMessages::option_required(option.long_name));
-            parsing_failed();
-            return {};
+            report(result,
+                   {.code = ErrorCode::OptionRequired,
+                    .name = name_index->stable_name(option.long_name)});
+            are_valid = false;
+        } else if (missing_values_position != ParseError::no_token)
+        {
+            report(result,
+                   {.code = ErrorCode::InvalidNumOfValues,
+                    .name = name_index->stable_name(option.long_name),
+                    .token_index = missing_values_position,
+                    .num_values = option.num_values});
+            are_valid = false;
         }
 
-        if (found and not enough_values_given)
+        if (not are_valid and not is_collecting_errors())
         {
-            print_error(ErrorMessages::invalid_num_of_values(
-                option.long_name, option.num_values));
-            parsing_failed();
-            return {};
+            return false;
         }
+    }
+    return are_valid;
+}
+
+void Parser::add_description(std::string dsc)
+{
+    program_description = std::move(dsc);
+    definitions_changed();
+}
 
-        options.push_back(option);
+std::string Parser::help_message(std::string_view program_name) const
+{
+    std::lock_guard<std::mutex> lock(shared_state->help_mutex);
+    if (not shared_state->is_help_composed)
+    {
+        compose_help();
+        shared_state->is_help_composed = true;
     }
-    return options;
+
+    const std::string &help = shared_state->help;
+    std::size_t position = shared_state->program_name_position;
+    std::string message;
+    message.reserve(help.size() + program_name.size());
+    message.append(help, 0, position);
+    message += program_name;
+    message.append(help, position);
+    return message;
 }
 
-void Parser::extract_option(const std::vector<std::string> &cmd_line,
-                            OptionBase &option, bool &found,
-                            bool &enough_values_given)
+// called with help_mutex locked
+void Parser::compose_help() const
 {
-    found = false;
-    enough_values_given = false;
+    std::vector<HelpRow> flags;
+    std::vector<HelpRow> required_options;
+    std::vector<HelpRow> options;
+    std::vector<HelpRow> positionals;
+    std::vector<HelpRow> subcommand_rows;
+
+    std::string usage = " [FLAGS] [OPTIONS]";
+    if (not subcommands.empty())
+    {
+        usage += " [SUBCOMMAND]";
+    }
+    for (const auto &subcommand : subcommands)
+    {
+        subcommand_rows.push_back({subcommand->name, subcommand->description});
+    }
 
-    for (int i = 1; i < cmd_line.size(); i++)
+    for (const Flag &f : definitions->flags)
     {
-        if (option.is_cmd_line_item(cmd_line[i]))
-        {
-            found = true;
+        flags.push_back({argument_usage(f, ""), f.description});
+    }
 
-            if (is_num_values_correct(option.num_values, i, cmd_line))
-            {
-                enough_values_given = true;
-            } else
-            {
-                return;
-            }
+    for (const Option &opt : definitions->options)
+    {
+        if (opt.required)
+        {
+            usage += " --" + opt.long_name + " VALUE";
+        }
+        (opt.required ? required_options : options)
+            .push_back({argument_usage(opt, " VALUE"), opt.description});
+    }
 
-            occupied_positions.at(i) = true;
-            for (int j = 1; j <= option.num_values; j++)
-            {
-                option.set_value(cmd_line[i + j]);
-                occupied_positions.at(i + j) = true;
-            }
+    for (const VectorOption &opt : definitions->vec_options)
+    {
+        std::string values = " " + std::to_string(opt.num_values) + " VALUES";
+        if (opt.required)
+        {
+            usage += " --" + opt.long_name + values;
         }
+        (opt.required ? required_options : options)
+            .push_back({argument_usage(opt, values), opt.description});
     }
-}
 
-bool Parser::is_num_values_correct(int defined_num_values, int current_position,
-                                   const std::vector<std::string> &cmd_line)
-{
-    bool is_enough_values_given =
-        (current_position < cmd_line.size() - defined_num_values);
-    if (is_enough_values_given)
+    for (const Positional &positional : definitions->positionals)
+    {
+        usage += " " + positional.long_name;
+        positionals.push_back({positional.long_name, positional.description});
+    }
+    if (positional_list.required)
+    {
+        usage += " " + positional_list.long_name + "...";
+        positionals.push_back(
+            {positional_list.long_name, positional_list.description});
+    }
+
+    std::size_t width = 0;
+    for (const std::vector<HelpRow> *rows :
+         {&flags, &required_options, &options, &positionals,
+          &subcommand_rows})
     {
-        for (int i = 0; i < defined_num_values; i++)
+        for (const HelpRow &row : *rows)
         {
-            if (is_shell_argument(cmd_line[current_position + 1 + i]))
-            {
-                return false;
-            }
+            width = std::max(width, row.usage.size());
         }
     }
-    return is_enough_values_given;
-}
 
-std::vector<Positional> Parser::parse_positional(
-    const std::vector<std::string> &cmd_line)
-{
-    std::vector<Positional> positionals = collect_positionals(cmd_line);
-    if (not are_positionals_valid(positionals))
+    std::string &help = shared_state->help;
+    help = "\n" + program_description + "\n\nUsage:\n\t";
+    shared_state->program_name_position = help.size();
+    help += usage + "\n";
+    append_help_section(help, "FLAGS:", flags, width);
+    append_help_section(help, "OPTIONS (required):", required_options, width);
+    append_help_section(help, "OPTIONS:", options, width);
+    append_help_section(help, "POSITIONAL ARGUMENTS:", positionals, width);
+    if (not subcommand_rows.empty())
     {
-        return {};
+        append_help_section(help, "SUBCOMMANDS:", subcommand_rows, width);
     }
-    num_positionals = positionals.size();
+    help += "\n";
+}
 
-    return positionals;
+void Parser::print_help(std::string_view program_name) const
+{
+    write_stdout(help_message(program_name));
 }
 
-std::vector<Positional> Parser::collect_positionals(
-    const std::vector<std::string> &cmd_line)
+void Parser::set_choices(const std::string &long_name,
+                         std::vector<std::string> values)
 {
-    std::vector<Positional> positionals;
-    positionals.reserve(user_defined_args.positionals.size());
+    const ArgumentId *id = name_index->find_long(long_name);
+    if (id == nullptr or (id->kind != ArgumentKind::Option and
+                          id->kind != ArgumentKind::VectorOption))
+    {
+        report(definition_result,
+               {.code = ErrorCode::UnknownOption,
+                .name = mutable_name_index().intern(long_name)});
+        return;
+    }
 
-    unsigned int num_processed_positionals = 0;
-    for (int i = 1; i < occupied_positions.size(); i++)
+    Choices option_choices{*id, std::move(values), {}};
+    for (std::size_t i = 0; i < option_choices.values.size(); i++)
     {
-        if (not occupied_positions.at(i) and
-            (not is_shell_argument(cmd_line.at(i))))
-        {
-            std::string long_name =
-                num_processed_positionals < user_defined_args.positionals.size()
-                    ? user_defined_args.positionals
-                          .at(num_processed_positionals)
-                          .long_name
-                    : "";
+        option_choices.trie.insert(option_choices.values[i], i);
+    }
 
-            positionals.emplace_back(long_name, cmd_line.at(i));
-            num_processed_positionals++;
-        }
+    auto it = std::find_if(choices.begin(), choices.end(),
+                           [&](const Choices &c) { return c.id == *id; });
+    if (it != choices.end())
+    {
+        *it = std::move(option_choices);
+    } else
+    {
+        choices.push_back(std::move(option_choices));
     }
-    return positionals;
 }
 
-bool Parser::are_positionals_valid(const std::vector<Positional> &positionals)
+const Parser::Choices *Parser::find_choices(ArgumentId id) const
 {
-    if (positionals.size() < user_defined_args.positionals.size())
+    for (const Choices &option_choices : choices)
     {
-        print_error(ErrorMessages::positional_required(
-            user_defined_args.positionals.at(positionals.size()).long_name));
-        parsing_failed();
-        return false;
+        if (option_choices.id == id)
+        {
+            return &option_choices;
+        }
     }
-    return true;
+    return nullptr;
 }
 
-void Parser::add_description(std::string dsc) { program_description = dsc; }
-
-void Parser::compose_help()
+bool Parser::are_choices_valid(const Args &args, ParseResult &result) const
 {
-    std::stringstream ss;
-    ss << std::endl << program_description << std::endl << std::endl;
-
-    ss << "Usage:" << std::endl;
-    ss << "\t" << program_name << " [FLAGS] [OPTIONS]";
-
-    for (Option &opt : user_defined_args.options)
-    {
-        if (!opt.required)
+    bool are_valid = true;
+    auto check = [&](std::string_view value, const Choices &option_choices) {
+        if (option_choices.trie.find(value) == Trie::npos)
         {
-            continue;
+            report(result,
+                   invalid_value(option_choices.id, value,
+                                 args.option_position(option_choices.id,
+                                                      value)));
+            are_valid = false;
         }
-        ss << " --" << opt.long_name << " VALUE";
-    }
+    };
 
-    for (VectorOption &opt : user_defined_args.vec_options)
+    for (const Choices &option_choices : choices)
     {
-        if (!opt.required)
+        if (option_choices.id.kind == ArgumentKind::Option)
         {
+            if (const std::string_view *value =
+                    args.given_value(option_choices.id.index))
+            {
+                check(*value, option_choices);
+            }
             continue;
         }
-        ss << " --" << opt.long_name << " " << opt.num_values << " VALUES";
+
+        args.visit_values(option_choices.id, [&](std::string_view value) {
+            check(value, option_choices);
+        });
     }
+    return are_valid;
+}
 
-    for (auto &positional : user_defined_args.positionals)
+const Parser::PrefixIndex &Parser::prefix_index() const
+{
+    if (const PrefixIndex *built = shared_state->built_completion.load(
+            std::memory_order_acquire))
     {
-        ss << " " << positional.long_name;
+        return *built;
     }
-    if (positional_list.required)
+    std::lock_guard<std::mutex> lock(shared_state->completion_mutex);
+    if (shared_state->completion)
     {
-        ss << " " << positional_list.long_name << "...";
+        return *shared_state->completion;
     }
-    ss << std::endl << std::endl;
 
-    ss << "FLAGS: " << std::endl;
-    for (Flag &f : user_defined_args.flags)
-    {
-        if (f.short_name.empty())
-        {
-            ss << "    ";
-        } else
+    auto index = std::make_unique<PrefixIndex>();
+    auto add_names = [&](const CmdLineArgumentBase &argument, ArgumentId id) {
+        index->words.push_back("--" + argument.long_name);
+        index->ids.push_back(id);
+        if (not argument.short_name.empty())
         {
-            ss << "-" << f.short_name << ", ";
+            index->words.push_back("-" + argument.short_name);
+            index->ids.push_back(id);
         }
-        ss << "--" << f.long_name << "\t" << f.description << std::endl;
+    };
+    const Definitions &defined = *definitions;
+    for (std::size_t i = 0; i < defined.flags.size(); i++)
+    {
+        add_names(defined.flags[i], {ArgumentKind::Flag, i});
     }
-
-    ss << std::endl << "OPTIONS (required):" << std::endl;
-    for (Option &opt : user_defined_args.options)
+    for (std::size_t i = 0; i < defined.options.size(); i++)
     {
-        if (!opt.required)
-        {
-            continue;
-        }
+        add_names(defined.options[i], {ArgumentKind::Option, i});
+    }
+    for (std::size_t i = 0; i < defined.vec_options.size(); i++)
+    {
+        add_names(defined.vec_options[i], {ArgumentKind::VectorOption, i});
+    }
 
-        if (opt.short_name.empty())
-        {
-            ss << "    ";
-        } else
-        {
-            ss << "-" << opt.short_name << ", ";
-        }
-        ss << "--" << opt.long_name << " VALUE"
-           << "\t" << opt.description << std::endl;
+    for (std::size_t i = 0; i < index->words.size(); i++)
+    {
+        index->names.insert(index->words[i], i);
+    }
+    for (std::size_t i = 0; i < subcommands.size(); i++)
+    {
+        index->subcommand_names.insert(subcommands[i]->name, i);
     }
 
-    for (VectorOption &opt : user_defined_args.vec_options)
+    shared_state->completion = std::move(index);
+    shared_state->built_completion.store(shared_state->completion.get(),
+                                         std::memory_order_release);
+    return *shared_state->completion;
+}
+
+std::vector<std::string_view> Parser::complete(
+    std::span<const std::string_view> words, std::size_t cword) const
+{
+    std::vector<std::string_view> candidates;
+    visit_candidates(words, cword, true,
+                     [&](std::string_view, std::string_view candidate) {
+                         candidates.push_back(candidate);
+                     });
+    return candidates;
+}
+
+template <typename Add>
+void Parser::visit_candidates(std::span<const std::string_view> words,
+                              std::size_t cword, bool is_indexed,
+                              Add &&add) const
+{
+    if (cword == 0 or cword > words.size())
     {
-        if (!opt.required)
-        {
-            continue;
-        }
+        return;
+    }
+    std::string_view word = cword < words.size() ? words[cword] : "";
 
-        if (opt.short_name.empty())
-        {
-            ss << "    ";
-        } else
+    if (cword > 1)
+    {
+        if (const Subcommand *subcommand = find_subcommand(words[1]))
         {
-            ss << "-" << opt.short_name << ", ";
+            subcommand_parser(*subcommand)
+                .visit_candidates(words.subspan(1), cword - 1, is_indexed,
+                                  add);
+            return;
         }
-        ss << "--" << opt.long_name << " " << opt.num_values << " VALUES"
-           << "\t" << opt.description << std::endl;
     }
 
-    ss << std::endl << "OPTIONS:" << std::endl;
-    for (Option &opt : user_defined_args.options)
+    // a value is expected after an option
+    const ArgumentId *previous = find_argument(words[cword - 1]);
+    if (previous != nullptr and (previous->kind == ArgumentKind::Option or
+                                 previous->kind == ArgumentKind::VectorOption))
     {
-        if (opt.required)
+        if (const Choices *option_choices = find_choices(*previous))
         {
-            continue;
+            option_choices->trie.visit_prefix(word, [&](std::size_t i) {
+                add("", option_choices->values[i]);
+            });
         }
+        return;
+    }
 
-        if (opt.short_name.empty())
+    if (is_indexed)
+    {
+        const PrefixIndex &index = prefix_index();
+        if (not word.empty() and word[0] == '-')
         {
-            ss << "    ";
-        } else
+            index.names.visit_prefix(word, [&](std::size_t i) {
+                add("", index.words[i]);
+            });
+        } else if (cword == 1)
         {
-            ss << "-" << opt.short_name << ", ";
+            index.subcommand_names.visit_prefix(word, [&](std::size_t i) {
+                add("", subcommands[i]->name);
+            });
         }
-        ss << "--" << opt.long_name << " VALUE"
-           << "\t" << opt.description << std::endl;
+        return;
     }
 
-    for (VectorOption &opt : user_defined_args.vec_options)
+    if (not word.empty() and word[0] == '-')
     {
-        if (opt.required)
-        {
-            continue;
-        }
-
-        if (opt.short_name.empty())
-        {
-            ss << "    ";
-        } else
+        auto add_matching = [&](std::string_view dashes,
+                                std::string_view name) {
+            bool is_match = word.size() <= dashes.size()
+                                ? dashes.starts_with(word)
+                                : word.starts_with(dashes) and
+                                      name.starts_with(
+                                          word.substr(dashes.size()));
+            if (is_match and not name.empty())
+            {
+                add(dashes, name);
+            }
+        };
+        auto add_names = [&](const auto &arguments) {
+            for (const CmdLineArgumentBase &argument : arguments)
+            {
+                add_matching("--", argument.long_name);
+                add_matching("-", argument.short_name);
+            }
+        };
+        add_names(definitions->flags);
+        add_names(definitions->options);
+        add_names(definitions->vec_options);
+    } else if (cword == 1)
+    {
+        for (const std::unique_ptr<Subcommand> &subcommand : subcommands)
         {
-            ss << "-" << opt.short_name << ", ";
+            if (std::string_view(subcommand->name).starts_with(word))
+            {
+                add("", subcommand->name);
+            }
         }
-        ss << "--" << opt.long_name << " " << opt.num_values << " VALUES"
-           << "\t" << opt.description << std::endl;
     }
+}
 
-    ss << std::endl << "POSITIONAL ARGUMENTS:" << std::endl;
-    for (Positional &opt : user_defined_args.positionals)
+void Parser::print_completions(const CmdLine &cmd_line, Args &args) const
+{
+    std::string_view cword_item = cmd_line[2];
+    std::size_t cword = 0;
+    std::from_chars(cword_item.data(), cword_item.data() + cword_item.size(),
+                    cword);
+
+    std::vector<std::string_view> words;
+    words.reserve(cmd_line.size() - 3);
+    for (std::size_t i = 3; i < cmd_line.size(); i++)
     {
-        ss << opt.long_name << "\t" << opt.description << std::endl;
+        words.push_back(cmd_line[i]);
     }
-    ss << std::endl;
-    if (positional_list.required)
+
+    // a single completion per process, so the prefix index is not built
+    std::vector<std::string> candidates;
+    visit_candidates(words, cword, false,
+                     [&](std::string_view dashes, std::string_view name) {
+                         std::string &candidate = candidates.emplace_back();
+                         candidate.reserve(dashes.size() + name.size() + 1);
+                         candidate += dashes;
+                         candidate += name;
+                         candidate += '\n';
+                     });
+    std::sort(candidates.begin(), candidates.end());
+
+    std::string output;
+    for (const std::string &candidate : candidates)
     {
-        ss << positional_list.long_name << "\t" << positional_list.description
-           << std::endl;
+        output += candidate;
     }
+    write_stdout(output);
+    args.result.is_completion_requested = true;
+}
 
-    ss << std::endl;
+std::string Parser::completion_script(Shell shell,
+                                      std::string_view program_name)
+{
+    std::string_view command =
+        program_name.substr(program_name.find_last_of('/') + 1);
+    std::string function = "_" + identifier(command) + "_complete";
+    std::string name(command);
 
-    help_message = ss.str();
+    switch (shell)
+    {
+        case Shell::Bash:
+            return function + "()\n"
+                   "{\n"
+                   "    local IFS=$'\\n'\n"
+                   "    COMPREPLY=($(\"${COMP_WORDS[0]}\" __complete "
+                   "\"$COMP_CWORD\" \"${COMP_WORDS[@]}\" 2>/dev/null))\n"
+                   "}\n"
+                   "complete -o default -F " + function + " " + name + "\n";
+        case Shell::Zsh:
+            return "#compdef " + name + "\n" + function + "()\n"
+                   "{\n"
+                   "    local -a candidates\n"
+                   "    candidates=(${(f)\"$(\"${words[1]}\" __complete "
+                   "$((CURRENT - 1)) \"${words[@]}\" 2>/dev/null)\"})\n"
+                   "    if (( ${#candidates} )); then\n"
+                   "        compadd -a candidates\n"
+                   "    else\n"
+                   "        _files\n"
+                   "    fi\n"
+                   "}\n"
+                   "compdef " + function + " " + name + "\n";
+        case Shell::Fish:
+            return "function " + function + "\n"
+                   "    set -l words (commandline -opc)\n"
+                   "    set -l current (commandline -ct)\n"
+                   "    $words[1] __complete (count $words) $words "
+                   "\"$current\" 2>/dev/null\n"
+                   "end\n"
+                   "complete -c " + name + " -a '(" + function + ")'\n";
+    }
+    return {};
 }
 
-void Parser::print_help() const { std::cout << help_message; }
-
 }  // namespace cppargs
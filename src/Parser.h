@@ -1,25 +1,83 @@
 #pragma once
 
-#include <cstdio>
-#include <cstring>
-#include <regex>
+#include <array>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
 
 #include "Args.h"
+#include "CmdLine.h"
 #include "ErrorMessages.h"
+#include "NameIndex.h"
+#include "ParseResult.h"
+#include "Trie.h"
 
 namespace cppargs {
 
+// ParseStats.h, only needed for instrumentation
+class ParseObserver;
+struct ParseStats;
+
+// Definitions for bulk registration with Parser::add_flags / add_options
+struct FlagSpec
+{
+    char short_name = '\0';
+    std::string_view long_name;
+    std::string_view description;
+};
+
+// an option if num_values is 1, a vector option otherwise
+struct OptionSpec
+{
+    char short_name = '\0';
+    std::string_view long_name;
+    std::string_view description;
+    bool required = false;
+    std::string_view default_value;
+    int num_values = 1;
+};
+
+enum class Shell
+{
+    Bash,
+    Zsh,
+    Fish
+};
+
+// Receives what Parser::visit finds, in command line order. Returning false
+// stops the walk. Ids can be compared with Parser::find(long_name).
+class ArgumentVisitor
+{
+public:
+    virtual ~ArgumentVisitor() = default;
+
+    virtual bool on_flag(ArgumentId id) = 0;
+    // once for each value of an option or vector option
+    virtual bool on_option(ArgumentId id, std::string_view value) = 0;
+    // index counts all positionals, also those beyond the defined ones
+    virtual bool on_positional(std::size_t index, std::string_view value) = 0;
+    // the message is ParseResult::message(error); stops by default
+    virtual bool on_error(const ParseError &) { return false; }
+};
+
 class Parser
 {
 public:
     Parser();
-    ~Parser() = default;
+    ~Parser();
 
-    std::string help_message;
+    // Parsed Args share the definitions' names, so Parsers are only moved
+    Parser(const Parser &) = delete;
+    Parser &operator=(const Parser &) = delete;
+    Parser(Parser &&) noexcept;
+    Parser &operator=(Parser &&) noexcept;
 
-    void add_flag(std::string long_name, std::string description);
-    void add_flag(char short_name, std::string long_name,
-                  std::string description);
+    FlagHandle add_flag(std::string long_name, std::string description);
+    FlagHandle add_flag(char short_name, std::string long_name,
+                        std::string description);
 
     void add_option(char short_name, std::string long_name,
                     std::string description, bool required,
@@ -34,56 +92,682 @@ public:
 
     void add_positional(std::string long_name, std::string description);
 
+    // Typed variants, e.g. add_option<int>(...). The value is converted to T
+    // once, during parse_args, and read with args[handle].
+    template <typename T>
+    OptionHandle<T> add_option(char short_name, std::string long_name,
+                               std::string description, bool required,
+                               std::string default_value);
+    template <typename T>
+    OptionHandle<T> add_option(std::string long_name, std::string description,
+                               bool required, std::string default_value);
+
+    template <typename T>
+    VecOptionHandle<T> add_vec_option(char short_name, std::string long_name,
+                                      std::string description, int num_values,
+                                      bool requred);
+    template <typename T>
+    VecOptionHandle<T> add_vec_option(std::string long_name,
+                                      std::string description, int num_values,
+                                      bool requred);
+
+    template <typename T>
+    PositionalHandle<T> add_positional(std::string long_name,
+                                       std::string description);
+
+    // Each definition is validated against the name index (and the ones
+    // before it in the batch) once, in a single pass. Invalid ones are
+    // reported and skipped, like with add_flag / add_option.
+    void add_flags(std::span<const FlagSpec> specs);
+    void add_options(std::span<const OptionSpec> specs);
+
     void add_positional_list(std::string long_name, std::string description);
     void add_description(std::string dsc);
 
-    Args parse_args(int argc, char *argv[]);
-    Args parse_args(const std::vector<std::string> &cmd_line);
+    // Subcommand selected by the first argument, e.g. "tool commit --amend".
+    // Its arguments are defined by build, which is only called the first time
+    // the subcommand is parsed. The rest of the command line is then parsed
+    // by the subcommand alone; see Args::subcommand(). It uses the error sink,
+    // observer, abbreviations and error collection set on this parser.
+    using SubcommandBuilder = std::function<void(Parser &subcommand)>;
+    void add_subcommand(std::string name, std::string description,
+                        SubcommandBuilder build);
+
+    // Values in the returned Args point into argv / cmd_line, which have to
+    // outlive it. Nothing is copied until a value is converted.
+    // Once the arguments are defined, parse_args can be called any number of
+    // times, also concurrently from many threads.
+    Args parse_args(int argc, char *argv[]) const;
+    Args parse_args(const std::vector<std::string> &cmd_line) const;
+    // a temporary command line would leave the Args dangling
+    Args parse_args(std::vector<std::string> &&cmd_line) const = delete;
+
+    // The containers of the returned Args are allocated from memory, e.g. a
+    // std::pmr::monotonic_buffer_resource released after each request. It
+    // has to outlive the Args.
+    Args parse_args(int argc, char *argv[],
+                    std::pmr::memory_resource *memory) const;
+    Args parse_args(const std::vector<std::string> &cmd_line,
+                    std::pmr::memory_resource *memory) const;
+    Args parse_args(std::vector<std::string> &&cmd_line,
+                    std::pmr::memory_resource *memory) const = delete;
+
+    // Parses into args, reusing the memory they hold. Once args have been
+    // used for a command line like this one, nothing is allocated, unless
+    // errors are printed or typed values need more room.
+    void parse_args(int argc, char *argv[], Args &args) const;
+    void parse_args(const std::vector<std::string> &cmd_line,
+                    Args &args) const;
+    void parse_args(std::vector<std::string> &&cmd_line,
+                    Args &args) const = delete;
+
+    // Streams the command line to visitor without making Args or storing
+    // anything per item, so memory use does not grow with argc. Definitions
+    // are those of add_*, help is not printed and subcommands are not parsed.
+    // Returns false if the visitor stopped, or on definition errors.
+    bool visit(int argc, char *argv[], ArgumentVisitor &visitor) const;
+    bool visit(const std::vector<std::string> &cmd_line,
+               ArgumentVisitor &visitor) const;
+    bool visit(std::vector<std::string> &&cmd_line,
+               ArgumentVisitor &visitor) const = delete;
 
-    bool errors_occured() const { return not is_parsing_successful; }
+    // id of the argument with long_name, nullptr if there is none; e.g. to
+    // tell which argument an ArgumentVisitor is called for. Valid until the
+    // next argument is defined.
+    const ArgumentId *find(std::string_view long_name) const
+    {
+        return name_index->find_long(long_name);
+    }
+
+    // Struct binding: an argument is stored straight into a member of the
+    // caller's struct, e.g. bind_option(&Config::threads, 't', "threads",
+    // ...), by parse_args(argc, argv, config). No Args are made. Flags are
+    // set to whether they were given. Options and positionals not given get
+    // their default value if they have one, otherwise the member is left as
+    // it was. Subcommands are not parsed this way.
+    template <typename Config>
+    void bind_flag(bool Config::*member, char short_name,
+                   std::string long_name, std::string description);
+    template <typename Config>
+    void bind_flag(bool Config::*member, std::string long_name,
+                   std::string description);
+
+    template <typename Config, typename T>
+    void bind_option(T Config::*member, char short_name, std::string long_name,
+                     std::string description, bool required,
+                     std::string default_value);
+    template <typename Config, typename T>
+    void bind_option(T Config::*member, std::string long_name,
+                     std::string description, bool required,
+                     std::string default_value);
+
+    template <typename Config, typename T>
+    void bind_vec_option(std::vector<T> Config::*member, char short_name,
+                         std::string long_name, std::string description,
+                         int num_values, bool required);
+    template <typename Config, typename T>
+    void bind_vec_option(std::vector<T> Config::*member, std::string long_name,
+                         std::string description, int num_values,
+                         bool required);
 
-    void print_help() const;
+    template <typename Config, typename T>
+    void bind_positional(T Config::*member, std::string long_name,
+                         std::string description);
+
+    // Only members bound to Config are written. With errors, config may be
+    // written in part. Errors are collected and observed as by the other
+    // parse_args.
+    template <typename Config>
+        requires std::is_class_v<Config>
+    ParseResult parse_args(int argc, char *argv[], Config &config) const
+    {
+        return parse_into(CmdLine(argc, argv), typeid(Config), &config);
+    }
+    template <typename Config>
+        requires std::is_class_v<Config>
+    ParseResult parse_args(const std::vector<std::string> &cmd_line,
+                           Config &config) const
+    {
+        return parse_into(CmdLine(cmd_line), typeid(Config), &config);
+    }
+    // errors would view a temporary command line
+    template <typename Config>
+        requires std::is_class_v<Config>
+    ParseResult parse_args(std::vector<std::string> &&cmd_line,
+                           Config &config) const = delete;
+
+    // Parses every command line, spread over num_threads threads (0 for one
+    // per core). Results are in the order of cmd_lines and refer to them.
+    std::vector<Args> parse_batch(
+        std::span<const std::vector<std::string_view>> cmd_lines,
+        unsigned num_threads = 0) const;
+
+    // Errors in the definitions or in the latest parse. With concurrent
+    // parses use Args::errors_occured() instead.
+    bool errors_occured() const;
+
+    // Called with the message of every error as soon as it is found, prints
+    // to stderr by default. It has to be thread-safe if parse_args is called
+    // concurrently. Without a sink (nullptr) nothing is formatted, errors are
+    // only recorded in Args::parse_result() and definition_errors().
+    // The getters of Args report to the sink of the parser that made them.
+    using ErrorSink = cppargs::ErrorSink;
+    void set_error_sink(ErrorSink sink)
+    {
+        own_settings->error_sink =
+            std::make_shared<const ErrorSink>(std::move(sink));
+    }
+
+    // The first error in a group of arguments (options, vector options,
+    // positionals, typed values) stops its checks, unless all errors are
+    // collected. Either way they go to the error sink too.
+    void collect_all_errors(bool is_enabled)
+    {
+        own_settings->are_all_errors_collected = is_enabled;
+    }
+
+    // errors found by add_*
+    const ParseResult &definition_errors() const { return definition_result; }
+
+    // Accept unambiguous prefixes of long names, e.g. --verb for --verbose,
+    // like getopt_long. Prefixes of several names are reported as errors.
+    void allow_abbreviations(bool is_allowed = true)
+    {
+        own_settings->are_abbreviations_allowed = is_allowed;
+    }
+
+    // The only values an option (or each value of a vector option) accepts.
+    // They are offered by completion and checked by parse_args.
+    void set_choices(const std::string &long_name,
+                     std::vector<std::string> values);
+
+    // Candidates for words[cword] (words[0] being the program name): long and
+    // short names, subcommands or choices of the option before it. Neither
+    // help nor a parse is done; names are indexed by the first call.
+    std::vector<std::string_view> complete(
+        std::span<const std::string_view> words, std::size_t cword) const;
+
+    // Script to source in the shell. It calls the program as
+    // "program __complete CWORD WORDS..." on every TAB, which parse_args
+    // answers by printing the candidates of complete(WORDS, CWORD), one per
+    // line, found without an index, and returning Args with
+    // parse_result().completion_requested().
+    static std::string completion_script(Shell shell,
+                                         std::string_view program_name);
+
+    // nullptr to stop observing; the observer has to outlive the Parser and be
+    // thread-safe if parse_args is called concurrently
+    void set_observer(ParseObserver *parse_observer)
+    {
+        own_settings->observer = parse_observer;
+    }
+
+    // composed on first use and kept until the definitions change
+    std::string help_message(std::string_view program_name = {}) const;
+    void print_help(std::string_view program_name = {}) const;
 
 private:
-    bool is_parsing_successful;
-    void parsing_failed() { is_parsing_successful = false; }
-    Args user_defined_args;
-    std::vector<bool> occupied_positions;
-    unsigned long num_positionals = 0;
+    // shared with the parsed Args, copied before a change if any are alive
+    std::shared_ptr<Definitions> definitions;
+    Definitions &mutable_definitions();
     std::string program_description;
-    std::string program_name;
 
     PositionalList positional_list;
 
+    // definitions added through the typed add_* variants, indexed by the slots
+    // of their handles
+    // converts the value(s) of the definition at index, or sets invalid_value
+    // to the one that cannot be converted and returns false
+    using ConvertFunction = bool (*)(const Args &args, std::size_t index,
+                                     std::any &value,
+                                     std::string_view &invalid_value);
+    struct TypedArgument
+    {
+        ArgumentId id;
+        ConvertFunction convert;
+    };
+    std::vector<TypedArgument> typed_arguments;
+    std::size_t add_typed_argument(ArgumentId id, ConvertFunction convert);
+    bool convert_typed_values(const CmdLine &cmd_line, Args &args,
+                              ParseStats *stats) const;
+    const CmdLineArgumentBase &definition(ArgumentId id) const;
+
+    // Members bound by bind_*, of the struct of type config_type. assign
+    // converts value into the member of the struct at config; the values of
+    // vector members are appended, after clearing them for the first one.
+    using AssignFunction = std::function<bool(
+        void *config, std::string_view value, bool is_first_value)>;
+    struct Binding
+    {
+        ArgumentId id;
+        const std::type_info *config_type;
+        AssignFunction assign;
+    };
+    std::vector<Binding> bindings;
+    // indices of bindings by the kind and index of their arguments
+    static constexpr std::size_t no_binding = static_cast<std::size_t>(-1);
+    std::array<std::vector<std::size_t>, 4> binding_indices;
+    void add_binding(ArgumentId id, const std::type_info &config_type,
+                     AssignFunction assign);
+    const Binding *find_binding(ArgumentId id,
+                                const std::type_info &config_type) const;
+    template <typename Config, typename T>
+    void bind_value(ArgumentId id, T Config::*member);
+    template <typename Config, typename T>
+    void bind_values(ArgumentId id, std::vector<T> Config::*member);
+    struct StructBinder;
+    struct VisitorCaller;
+    bool visit(const CmdLine &cmd_line, ArgumentVisitor &visitor) const;
+    ParseResult parse_into(const CmdLine &cmd_line,
+                           const std::type_info &config_type,
+                           void *config) const;
+    void bind_arguments(const CmdLine &cmd_line,
+                        const std::type_info &config_type, void *config,
+                        ParseStats *stats, ParseResult &result) const;
+
+    template <typename T>
+    static T &stored_value(std::any &value);
+    template <typename T>
+    static bool convert_option(const Args &args, std::size_t index,
+                               std::any &value,
+                               std::string_view &invalid_value);
+    template <typename T>
+    static bool convert_vec_option(const Args &args, std::size_t index,
+                                   std::any &value,
+                                   std::string_view &invalid_value);
+    template <typename T>
+    static bool convert_positional(const Args &args, std::size_t index,
+                                   std::any &value,
+                                   std::string_view &invalid_value);
+
+    // names of all defined arguments, used to dispatch command line items to
+    // their definitions. Shared with parsed Args and their errors, so it is
+    // copied before a change while they refer to it.
+    std::shared_ptr<NameIndex> name_index;
+    NameIndex &mutable_name_index();
+    void index_argument(char short_name, const std::string &long_name,
+                        ArgumentId id);
+    void reserve_names(std::size_t num_names);
+
+    // Set on the parser itself. Subcommands read the settings of the
+    // top-level parser, whenever they parse.
+    struct Settings
+    {
+        // shared with the parsed Args, which may outlive the parser
+        std::shared_ptr<const ErrorSink> error_sink;
+        ParseObserver *observer = nullptr;
+        bool are_abbreviations_allowed = false;
+        bool are_all_errors_collected = false;
+    };
+    std::unique_ptr<Settings> own_settings;
+    const Settings *settings;
+
+    ParseResult definition_result;
+    bool is_collecting_errors() const
+    {
+        return settings->are_all_errors_collected;
+    }
+    void report(ParseResult &result, const ParseError &error) const;
+    static void clear(Args &args);
+    static void fail(Args &args);
+    const ArgumentId *find_argument(std::string_view cmd_line_item) const;
+
     bool is_name_valid(char short_name, const std::string &long_name);
     bool is_name_valid(const std::string &long_name);
 
-    std::vector<Flag> parse_flags(const std::vector<std::string> &cmd_line);
+    // parse_args keeps no state of its own, except for the help and the
+    // outcome of the latest parse
+    struct SharedState;
+    std::unique_ptr<SharedState> shared_state;
+
+    struct Subcommand;
+    std::vector<std::unique_ptr<Subcommand>> subcommands;
+    std::unordered_map<std::string, std::size_t, StringHash, std::equal_to<>>
+        subcommand_index;
+    const Subcommand *find_subcommand(std::string_view name) const;
+    const Parser &subcommand_parser(const Subcommand &subcommand) const;
+    void parse_subcommand(const Subcommand &subcommand,
+                          const CmdLine &cmd_line, Args &args) const;
+
+    struct Choices
+    {
+        ArgumentId id;
+        std::vector<std::string> values;
+        Trie trie;
+    };
+    std::vector<Choices> choices;
+    const Choices *find_choices(ArgumentId id) const;
+    bool are_choices_valid(const Args &args, ParseResult &result) const;
+
+    // names by prefix, for complete() and abbreviations, built on first use
+    struct PrefixIndex;
+    const PrefixIndex &prefix_index() const;
+    const ArgumentId *find_abbreviation(std::string_view cmd_line_item,
+                                        bool &is_ambiguous) const;
+    // Calls add(dashes, name) for every candidate for words[cword]. Names are
+    // found in the prefix index if is_indexed, else by scanning the
+    // definitions, which is cheaper for a single completion.
+    template <typename Add>
+    void visit_candidates(std::span<const std::string_view> words,
+                          std::size_t cword, bool is_indexed, Add &&add) const;
+    void print_completions(const CmdLine &cmd_line, Args &args) const;
+
+    // records the outcome for errors_occured()
+    void parse_and_record(const CmdLine &cmd_line, Args &args) const;
+    void parse(const CmdLine &cmd_line, Args &args) const;
+    // args.program_name includes the names of the enclosing subcommands
+    void parse_arguments(const CmdLine &cmd_line, Args &args) const;
+    // stats is nullptr if there is no observer
+    void parse_arguments(const CmdLine &cmd_line, ParseStats *stats,
+                         Args &args) const;
+    // Calls parse(stats), which are measured and passed on to the observer,
+    // if there is one. Otherwise stats is nullptr.
+    template <typename Parse>
+    void observe(Parse &&parse) const;
+
+    // Items found by tokenize go to a handler: flag(id), option(id, position,
+    // is_complete) followed by value(value) for each of its values,
+    // positional(item, position) and error(error). It stops once stopped() is
+    // true.
+    struct NameLookup;
+    struct ArgsRecorder;
+    struct GivenArguments;
+    template <typename Handler>
+    void report_missing(const GivenArguments &given, Handler &handler) const;
+    template <typename Handler>
+    void report_missing_positionals(std::size_t num_positionals,
+                                    Handler &handler) const;
+    ParseError incomplete_option(ArgumentId id, std::size_t position) const;
+    ParseError invalid_value(ArgumentId id, std::string_view value,
+                             std::size_t position) const;
+    template <typename Handler>
+    void tokenize(const CmdLine &cmd_line, Handler &handler,
+                  ParseStats *stats) const;
 
     template <typename T>
-    std::vector<T> parse_options(const std::vector<std::string> &cmd_line,
-                                 const std::vector<T> &user_defined_options);
-    std::vector<Positional> parse_positional(
-        const std::vector<std::string> &cmd_line);
+    bool are_options_valid(const std::vector<T> &options,
+                           std::span<const std::size_t> required,
+                           std::span<const Args::GivenOption> given,
+                           ParseResult &result) const;
+    template <typename T>
+    bool is_default_value_valid(const std::string &long_name,
+                                const std::string &default_value);
 
-    void extract_option(const std::vector<std::string> &cmd_line,
-                        OptionBase &option, bool &found,
-                        bool &enough_values_given);
+    void definitions_changed();
+    void compose_help() const;
 
-    void compose_help();
+    static bool is_shell_argument(std::string_view str)
+    {
+        return utils::is_shell_argument(str);
+    }
+};
 
-    static bool is_shell_argument(const std::string &str)
+template <typename T>
+OptionHandle<T> Parser::add_option(char short_name, std::string long_name,
+                                   std::string description, bool required,
+                                   std::string default_value)
+{
+    std::size_t index = definitions->options.size();
+    if (not is_default_value_valid<T>(long_name, default_value))
+    {
+        return {};
+    }
+    add_option(short_name, std::move(long_name), std::move(description),
+               required, std::move(default_value));
+    if (definitions->options.size() == index)
     {
-        return regex_match(str, std::regex("--?[a-zA-Z]*"));
+        return {};
     }
+    return {add_typed_argument({ArgumentKind::Option, index},
+                               &convert_option<T>)};
+}
 
-    void init_occupied_positions(std::vector<std::string> cmd_line);
-    std::vector<Positional> collect_positionals(
-        const std::vector<std::string> &cmd_line);
-    bool are_positionals_valid(const std::vector<Positional> &positionals);
-    static bool is_num_values_correct(int defined_num_values,
-                                      int current_position,
-                                      const std::vector<std::string> &cmd_line);
-};
+template <typename T>
+OptionHandle<T> Parser::add_option(std::string long_name,
+                                   std::string description, bool required,
+                                   std::string default_value)
+{
+    return add_option<T>('\0', std::move(long_name), std::move(description),
+                         required, std::move(default_value));
+}
+
+template <typename T>
+VecOptionHandle<T> Parser::add_vec_option(char short_name,
+                                          std::string long_name,
+                                          std::string description,
+                                          int num_values, bool requred)
+{
+    std::size_t index = definitions->vec_options.size();
+    add_vec_option(short_name, std::move(long_name), std::move(description),
+                   num_values, requred);
+    if (definitions->vec_options.size() == index)
+    {
+        return {};
+    }
+    return {add_typed_argument({ArgumentKind::VectorOption, index},
+                               &convert_vec_option<T>)};
+}
+
+template <typename T>
+VecOptionHandle<T> Parser::add_vec_option(std::string long_name,
+                                          std::string description,
+                                          int num_values, bool requred)
+{
+    return add_vec_option<T>('\0', std::move(long_name),
+                             std::move(description), num_values, requred);
+}
+
+template <typename T>
+PositionalHandle<T> Parser::add_positional(std::string long_name,
+                                           std::string description)
+{
+    std::size_t index = definitions->positionals.size();
+    add_positional(std::move(long_name), std::move(description));
+    if (definitions->positionals.size() == index)
+    {
+        return {};
+    }
+    return {add_typed_argument({ArgumentKind::Positional, index},
+                               &convert_positional<T>)};
+}
+
+template <typename Config>
+void Parser::bind_flag(bool Config::*member, char short_name,
+                       std::string long_name, std::string description)
+{
+    FlagHandle flag =
+        add_flag(short_name, std::move(long_name), std::move(description));
+    if (flag.is_valid())
+    {
+        bind_value({ArgumentKind::Flag, flag.index}, member);
+    }
+}
+
+template <typename Config>
+void Parser::bind_flag(bool Config::*member, std::string long_name,
+                       std::string description)
+{
+    bind_flag(member, '\0', std::move(long_name), std::move(description));
+}
+
+template <typename Config, typename T>
+void Parser::bind_option(T Config::*member, char short_name,
+                         std::string long_name, std::string description,
+                         bool required, std::string default_value)
+{
+    std::size_t index = definitions->options.size();
+    if (not is_default_value_valid<T>(long_name, default_value))
+    {
+        return;
+    }
+    add_option(short_name, std::move(long_name), std::move(description),
+               required, std::move(default_value));
+    if (definitions->options.size() != index)
+    {
+        bind_value({ArgumentKind::Option, index}, member);
+    }
+}
+
+template <typename Config, typename T>
+void Parser::bind_option(T Config::*member, std::string long_name,
+                         std::string description, bool required,
+                         std::string default_value)
+{
+    bind_option(member, '\0', std::move(long_name), std::move(description),
+                required, std::move(default_value));
+}
+
+template <typename Config, typename T>
+void Parser::bind_vec_option(std::vector<T> Config::*member, char short_name,
+                             std::string long_name, std::string description,
+                             int num_values, bool required)
+{
+    std::size_t index = definitions->vec_options.size();
+    add_vec_option(short_name, std::move(long_name), std::move(description),
+                   num_values, required);
+    if (definitions->vec_options.size() != index)
+    {
+        bind_values({ArgumentKind::VectorOption, index}, member);
+    }
+}
+
+template <typename Config, typename T>
+void Parser::bind_vec_option(std::vector<T> Config::*member,
+                             std::string long_name, std::string description,
+                             int num_values, bool required)
+{
+    bind_vec_option(member, '\0', std::move(long_name),
+                    std::move(description), num_values, required);
+}
+
+template <typename Config, typename T>
+void Parser::bind_positional(T Config::*member, std::string long_name,
+                             std::string description)
+{
+    std::size_t index = definitions->positionals.size();
+    add_positional(std::move(long_name), std::move(description));
+    if (definitions->positionals.size() != index)
+    {
+        bind_value({ArgumentKind::Positional, index}, member);
+    }
+}
+
+template <typename Config, typename T>
+void Parser::bind_value(ArgumentId id, T Config::*member)
+{
+    add_binding(id, typeid(Config),
+                [member](void *config, std::string_view value, bool) {
+                    return utils::convert_value(
+                        value, static_cast<Config *>(config)->*member);
+                });
+}
+
+template <typename Config, typename T>
+void Parser::bind_values(ArgumentId id, std::vector<T> Config::*member)
+{
+    add_binding(id, typeid(Config),
+                [member](void *config, std::string_view value,
+                         bool is_first_value) {
+                    std::vector<T> &values =
+                        static_cast<Config *>(config)->*member;
+                    if (is_first_value)
+                    {
+                        values.clear();
+                    }
+                    return utils::convert_value(value, values.emplace_back());
+                });
+}
+
+template <typename T>
+bool Parser::is_default_value_valid(const std::string &long_name,
+                                   const std::string &default_value)
+{
+    T value{};
+    if (default_value.empty() or utils::convert_value(default_value, value))
+    {
+        return true;
+    }
+    NameIndex &names = mutable_name_index();
+    report(definition_result, {.code = ErrorCode::InvalidValue,
+                               .name = names.intern(long_name),
+                               .value = names.intern(default_value)});
+    return false;
+}
+
+// The value left by the previous parse into the same Args is overwritten, so
+// e.g. the capacity of a std::string is reused.
+template <typename T>
+T &Parser::stored_value(std::any &value)
+{
+    T *stored = std::any_cast<T>(&value);
+    return stored != nullptr ? *stored : value.emplace<T>();
+}
+
+template <typename T>
+bool Parser::convert_option(const Args &args, std::size_t index,
+                            std::any &value, std::string_view &invalid_value)
+{
+    T &converted_value = stored_value<T>(value);
+    if (not args.has_value(index))
+    {
+        converted_value = T{};
+        return true;
+    }
+    if (not utils::convert_value(args.option_value(index), converted_value))
+    {
+        invalid_value = args.option_value(index);
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool Parser::convert_vec_option(const Args &args, std::size_t index,
+                                std::any &value,
+                                std::string_view &invalid_value)
+{
+    std::vector<T> &converted_values = stored_value<std::vector<T>>(value);
+    std::size_t num_converted = 0;
+    bool are_converted = true;
+    args.visit_values({ArgumentKind::VectorOption, index},
+                      [&](std::string_view given_value) {
+                          if (not are_converted)
+                          {
+                              return;
+                          }
+                          if (num_converted == converted_values.size())
+                          {
+                              converted_values.emplace_back();
+                          }
+                          if (not utils::convert_value(
+                                  given_value,
+                                  converted_values[num_converted++]))
+                          {
+                              invalid_value = given_value;
+                              are_converted = false;
+                          }
+                      });
+    converted_values.resize(num_converted);
+    return are_converted;
+}
+
+template <typename T>
+bool Parser::convert_positional(const Args &args, std::size_t index,
+                                std::any &value,
+                                std::string_view &invalid_value)
+{
+    T &converted_value = stored_value<T>(value);
+    if (index >= args.positionals.size())
+    {
+        converted_value = T{};
+        return true;
+    }
+    if (not utils::convert_value(args.positionals[index], converted_value))
+    {
+        invalid_value = args.positionals[index];
+        return false;
+    }
+    return true;
+}
 
 }  // namespace cppargs
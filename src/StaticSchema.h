@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "CmdLine.h"
+#include "ParseResult.h"
+#include "Tokenizer.h"
+#include "utils.h"
+
+// Schema known at compile time, e.g.
+//
+//   using Schema = cppargs::schema<cppargs::flag<'v', "verbose">,
+//                                  cppargs::option<int, 'n', "num">>;
+//   Schema::result args = Schema::parse(argc, argv);
+//   int num = args.get<"num">();
+//
+// Names are validated at compile time, nothing is registered at startup and
+// long names are dispatched through a perfect hash table. The help flag is not
+// added automatically. Use '\0' for arguments without a short name. The
+// command line is read by the same rules as with Parser (clusters, attached
+// values, "--"). Errors are collected in args.parse_result(), nothing is
+// printed.
+
+namespace cppargs {
+
+template <std::size_t N>
+struct fixed_string
+{
+    char data[N]{};
+
+    constexpr fixed_string(const char (&str)[N]) { std::copy_n(str, N, data); }
+    constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+template <char ShortName, fixed_string LongName>
+struct flag
+{
+    using value_type = bool;
+    static constexpr char short_name = ShortName;
+    static constexpr std::string_view long_name = LongName.view();
+    static constexpr int num_values = 0;
+};
+
+template <typename T, char ShortName, fixed_string LongName>
+struct option
+{
+    using value_type = T;
+    static constexpr char short_name = ShortName;
+    static constexpr std::string_view long_name = LongName.view();
+    static constexpr int num_values = 1;
+};
+
+template <typename T, char ShortName, fixed_string LongName, int NumValues>
+struct vec_option
+{
+    static_assert(NumValues >= 2,
+                  "vector options need at least 2 values, use option");
+
+    using value_type = std::vector<T>;
+    using element_type = T;
+    static constexpr char short_name = ShortName;
+    static constexpr std::string_view long_name = LongName.view();
+    static constexpr int num_values = NumValues;
+};
+
+namespace detail {
+
+// FNV-1a
+constexpr std::uint32_t hash_name(std::string_view name, std::uint32_t seed)
+{
+    std::uint32_t hash = 2166136261u ^ seed;
+    for (char c : name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr std::size_t next_power_of_two(std::size_t n)
+{
+    std::size_t power = 1;
+    while (power < n)
+    {
+        power *= 2;
+    }
+    return power;
+}
+
+template <std::size_t N>
+constexpr bool are_long_names_long_enough(
+    const std::array<std::string_view, N> &names)
+{
+    return std::all_of(names.begin(), names.end(),
+                       [](std::string_view name) { return name.size() >= 2; });
+}
+
+template <std::size_t N>
+constexpr bool are_names_without_spaces(
+    const std::array<std::string_view, N> &names)
+{
+    return std::none_of(names.begin(), names.end(), [](std::string_view name) {
+        return name.find(' ') != std::string_view::npos;
+    });
+}
+
+// names equal to unused are not compared
+template <typename Name, std::size_t N>
+constexpr bool are_unique(const std::array<Name, N> &names, Name unused)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        for (std::size_t j = i + 1; j < N; j++)
+        {
+            if (names[i] != unused and names[i] == names[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Hash and displace: names are split into buckets by their unseeded hash,
+// then every bucket (largest first) gets the first seed that moves all of its
+// names into free slots.
+template <std::size_t N>
+struct PerfectHash
+{
+    static constexpr std::size_t num_buckets = N > 0 ? N : 1;
+    static constexpr std::size_t table_size = next_power_of_two(2 * N);
+
+    std::array<std::uint32_t, num_buckets> seeds{};
+    // definition index + 1, 0 for empty slots
+    std::array<std::size_t, table_size> slots{};
+    bool is_valid = true;
+
+    constexpr std::size_t slot(std::string_view name) const
+    {
+        std::size_t bucket = hash_name(name, 0) % num_buckets;
+        return hash_name(name, seeds[bucket]) & (table_size - 1);
+    }
+};
+
+template <std::size_t N>
+constexpr PerfectHash<N> make_perfect_hash(
+    const std::array<std::string_view, N> &names)
+{
+    using Hash = PerfectHash<N>;
+    Hash hash;
+
+    std::array<std::size_t, Hash::num_buckets> bucket_sizes{};
+    std::array<std::size_t, Hash::num_buckets> bucket_order{};
+    for (std::size_t i = 0; i < N; i++)
+    {
+        bucket_sizes[hash_name(names[i], 0) % Hash::num_buckets]++;
+    }
+    for (std::size_t b = 0; b < Hash::num_buckets; b++)
+    {
+        bucket_order[b] = b;
+    }
+    std::sort(bucket_order.begin(), bucket_order.end(),
+              [&](std::size_t a, std::size_t b) {
+                  return bucket_sizes[a] > bucket_sizes[b];
+              });
+
+    for (std::size_t bucket : bucket_order)
+    {
+        if (bucket_sizes[bucket] == 0)
+        {
+            break;
+        }
+
+        bool is_placed = false;
+        for (std::uint32_t seed = 1; seed < 100000 and not is_placed; seed++)
+        {
+            std::array<std::size_t, Hash::table_size> slots = hash.slots;
+            is_placed = true;
+            for (std::size_t i = 0; i < N and is_placed; i++)
+            {
+                if (hash_name(names[i], 0) % Hash::num_buckets != bucket)
+                {
+                    continue;
+                }
+                std::size_t slot = hash_name(names[i], seed) &
+                                   (Hash::table_size - 1);
+                if (slots[slot] != 0)
+                {
+                    is_placed = false;
+                    continue;
+                }
+                slots[slot] = i + 1;
+            }
+
+            if (is_placed)
+            {
+                hash.seeds[bucket] = seed;
+                hash.slots = slots;
+            }
+        }
+        hash.is_valid = hash.is_valid and is_placed;
+    }
+    return hash;
+}
+
+}  // namespace detail
+
+template <typename... Arguments>
+class schema
+{
+public:
+    static constexpr std::size_t size = sizeof...(Arguments);
+
+    class result
+    {
+    public:
+        template <fixed_string Name>
+        const auto &get() const
+        {
+            constexpr std::size_t index = index_of(Name.view());
+            static_assert(index < size, "no argument with this name");
+            return std::get<index>(values);
+        }
+
+        // false for flags and options not given on the command line
+        template <fixed_string Name>
+        bool is_given() const
+        {
+            constexpr std::size_t index = index_of(Name.view());
+            static_assert(index < size, "no argument with this name");
+            return given[index];
+        }
+
+        bool errors_occured() const { return parse_errors.errors_occured(); }
+        const ParseResult &parse_result() const { return parse_errors; }
+
+        std::string_view program_name;
+        std::vector<std::string_view> positionals;
+
+    private:
+        friend class schema;
+
+        std::tuple<typename Arguments::value_type...> values;
+        std::bitset<size> given;
+        ParseResult parse_errors;
+    };
+
+    static result parse(int argc, char *argv[])
+    {
+        return parse(CmdLine(argc, argv));
+    }
+
+    // the result refers to cmd_line, which has to outlive it
+    static result parse(const CmdLine &cmd_line);
+
+    static constexpr std::size_t index_of(std::string_view long_name)
+    {
+        for (std::size_t i = 0; i < size; i++)
+        {
+            if (long_names[i] == long_name)
+            {
+                return i;
+            }
+        }
+        return size;
+    }
+
+private:
+    using Tuple = std::tuple<Arguments...>;
+
+    static constexpr std::array<std::string_view, size> long_names = {
+        Arguments::long_name...};
+    static constexpr std::array<char, size> short_names = {
+        Arguments::short_name...};
+    static constexpr std::array<int, size> num_values = {
+        Arguments::num_values...};
+
+    static_assert(detail::are_long_names_long_enough(long_names),
+                  "long names need at least 2 characters");
+    static_assert(detail::are_names_without_spaces(long_names),
+                  "names cannot contain spaces");
+    static_assert(detail::are_unique(long_names, std::string_view()),
+                  "long name is already specified");
+    static_assert(detail::are_unique(short_names, '\0'),
+                  "short name is already specified");
+
+    static constexpr detail::PerfectHash<size> long_name_table =
+        detail::make_perfect_hash(long_names);
+    static_assert(long_name_table.is_valid, "no perfect hash for long names");
+
+    // definition index + 1, 0 for letters not in use
+    static constexpr std::array<std::size_t, 256> short_name_table = [] {
+        std::array<std::size_t, 256> table{};
+        for (std::size_t i = 0; i < size; i++)
+        {
+            if (short_names[i] != '\0')
+            {
+                table[static_cast<unsigned char>(short_names[i])] = i + 1;
+            }
+        }
+        return table;
+    }();
+
+    // size if there is no such argument
+    static std::size_t find_long(std::string_view long_name)
+    {
+        std::size_t entry =
+            long_name_table.slots[long_name_table.slot(long_name)];
+        if (entry == 0 or long_names[entry - 1] != long_name)
+        {
+            return size;
+        }
+        return entry - 1;
+    }
+
+    static std::size_t find_short(char short_name)
+    {
+        std::size_t entry =
+            short_name_table[static_cast<unsigned char>(short_name)];
+        return entry == 0 ? size : entry - 1;
+    }
+
+    static std::size_t find(std::string_view cmd_line_item)
+    {
+        if (cmd_line_item.size() > 2 and cmd_line_item.substr(0, 2) == "--")
+        {
+            return find_long(cmd_line_item.substr(2));
+        }
+        if (cmd_line_item.size() == 2 and cmd_line_item[0] == '-')
+        {
+            return find_short(cmd_line_item[1]);
+        }
+        return size;
+    }
+
+    template <std::size_t I>
+    static bool store(result &args, std::string_view value)
+    {
+        using Argument = std::tuple_element_t<I, Tuple>;
+        auto &stored_value = std::get<I>(args.values);
+
+        if constexpr (Argument::num_values == 0)
+        {
+            stored_value = true;
+            return true;
+        } else if constexpr (Argument::num_values == 1)
+        {
+            return utils::convert_value(value, stored_value);
+        } else
+        {
+            typename Argument::element_type element{};
+            if (not utils::convert_value(value, element))
+            {
+                return false;
+            }
+            stored_value.push_back(std::move(element));
+            return true;
+        }
+    }
+
+    // dispatches to store<index>
+    template <std::size_t... I>
+    static bool store(result &args, std::size_t index, std::string_view value,
+                      std::index_sequence<I...>)
+    {
+        bool is_stored = false;
+        ((index == I ? (is_stored = store<I>(args, value), true) : false) or
+         ...);
+        return is_stored;
+    }
+
+    static bool store(result &args, std::size_t index, std::string_view value)
+    {
+        args.given[index] = true;
+        return store(args, index, value,
+                     std::index_sequence_for<Arguments...>{});
+    }
+
+    static void report(result &args, const ParseError &error)
+    {
+        args.parse_errors.error_list.push_back(error);
+    }
+
+    // the names of the arguments, for the tokenizer
+    struct NameLookup
+    {
+        static std::optional<tokenizer::NameMatch<std::size_t>> match(
+            std::size_t index)
+        {
+            if (index == size)
+            {
+                return std::nullopt;
+            }
+            return tokenizer::NameMatch<std::size_t>{index, num_values[index]};
+        }
+
+        template <typename Handler>
+        static std::optional<tokenizer::NameMatch<std::size_t>> find(
+            std::string_view name, std::size_t, Handler &)
+        {
+            return match(schema::find(name));
+        }
+
+        static std::optional<tokenizer::NameMatch<std::size_t>> find_short(
+            char short_name)
+        {
+            return match(schema::find_short(short_name));
+        }
+
+        static std::string_view long_name(std::size_t index)
+        {
+            return long_names[index];
+        }
+    };
+
+    // stores the items found by the tokenizer in the result
+    struct Recorder
+    {
+        result &args;
+        // the option whose values come next
+        std::size_t index = size;
+        std::size_t position = 0;
+
+        bool stopped() const { return false; }
+        void error(const ParseError &error) { report(args, error); }
+
+        void flag(std::size_t flag_index) { store(args, flag_index, {}); }
+
+        void option(std::size_t option_index, std::size_t option_position,
+                    bool is_complete)
+        {
+            index = option_index;
+            position = option_position;
+            if (not is_complete)
+            {
+                error({.code = ErrorCode::InvalidNumOfValues,
+                       .name = long_names[index],
+                       .token_index = position,
+                       .num_values = num_values[index]});
+            }
+        }
+
+        void value(std::string_view value)
+        {
+            if (not store(args, index, value))
+            {
+                error({.code = ErrorCode::InvalidValue,
+                       .name = long_names[index],
+                       .token_index = position,
+                       .value = value});
+            }
+        }
+
+        void positional(std::string_view item, std::size_t)
+        {
+            args.positionals.push_back(item);
+        }
+    };
+};
+
+template <typename... Arguments>
+typename schema<Arguments...>::result schema<Arguments...>::parse(
+    const CmdLine &cmd_line)
+{
+    result args;
+    if (cmd_line.empty())
+    {
+        return args;
+    }
+    args.program_name = cmd_line[0];
+
+    NameLookup names;
+    Recorder recorder{args};
+    tokenizer::tokenize(cmd_line, names, recorder);
+    return args;
+}
+
+}  // namespace cppargs
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+#include "CmdLine.h"
+#include "ParseResult.h"
+#include "utils.h"
+
+// Command line rules shared by Parser and the compile-time schema. Names are
+// looked up through a Names object:
+//
+//   std::optional<NameMatch<Id>> find(std::string_view name,
+//                                     std::size_t position, Handler &handler)
+//       "--long" or "-s", may report errors (e.g. ambiguity) to the handler
+//   std::optional<NameMatch<Id>> find_short(char short_name)
+//   std::string_view long_name(Id id)
+//
+// and the items found go to a Handler: flag(id), option(id, position,
+// is_complete) followed by value(value) for each of its values,
+// positional(item, position) and error(error). It stops once stopped() is
+// true.
+
+namespace cppargs::tokenizer {
+
+template <typename Id>
+struct NameMatch
+{
+    Id id;
+    // 0 for flags
+    int num_values = 0;
+};
+
+// Returns the position of the last command line item consumed by the option.
+// A value attached to it ("--name=value", "-nvalue") is the first one, the
+// rest follow.
+template <typename Id, typename Handler>
+std::size_t extract_option(
+    const CmdLine &cmd_line, std::size_t position, const NameMatch<Id> &option,
+    Handler &handler,
+    std::optional<std::string_view> attached_value = std::nullopt)
+{
+    int num_following = option.num_values - (attached_value ? 1 : 0);
+    bool is_complete =
+        utils::is_num_values_correct(num_following, position, cmd_line);
+    handler.option(option.id, position, is_complete);
+    if (not is_complete)
+    {
+        return position;
+    }
+
+    if (attached_value)
+    {
+        handler.value(*attached_value);
+    }
+    for (int j = 1; j <= num_following; j++)
+    {
+        handler.value(cmd_line[position + j]);
+    }
+    return position + num_following;
+}
+
+// Letters are looked up one by one. Flags are set, an option takes the rest of
+// the item as its value ("-ofile") or, when it is the last letter, the items
+// that follow ("-vo file"). An unknown letter ends the cluster. Returns the
+// position of the last command line item consumed.
+template <typename Names, typename Handler>
+std::size_t decode_cluster(const CmdLine &cmd_line, std::size_t position,
+                           Names &names, Handler &handler)
+{
+    std::string_view cluster = cmd_line[position];
+    for (std::size_t i = 1; i < cluster.size(); i++)
+    {
+        auto match = names.find_short(cluster[i]);
+        if (not match)
+        {
+            handler.error({.code = ErrorCode::UnknownShortName,
+                           .name = cluster,
+                           .token_index = position,
+                           .short_name = cluster[i]});
+            return position;
+        }
+        if (match->num_values == 0)
+        {
+            handler.flag(match->id);
+            continue;
+        }
+
+        if (i + 1 == cluster.size())
+        {
+            return extract_option(cmd_line, position, *match, handler);
+        }
+        return extract_option(cmd_line, position, *match, handler,
+                              cluster.substr(i + 1));
+    }
+    return position;
+}
+
+// "--name", "--name=value", "-s", clusters and positionals. Everything after
+// "--" is positional.
+template <typename Names, typename Handler>
+void tokenize(const CmdLine &cmd_line, Names &names, Handler &handler)
+{
+    for (std::size_t i = 1; i < cmd_line.size() and not handler.stopped(); i++)
+    {
+        std::string_view item = cmd_line[i];
+
+        if (item == "--")
+        {
+            for (i++; i < cmd_line.size() and not handler.stopped(); i++)
+            {
+                handler.positional(cmd_line[i], i);
+            }
+            break;
+        }
+
+        // "-xvf", "-ofile", "-vo file"
+        if (item.size() > 2 and item[0] == '-' and utils::is_letter(item[1]))
+        {
+            i = decode_cluster(cmd_line, i, names, handler);
+            continue;
+        }
+
+        bool is_long = item.size() > 2 and item.compare(0, 2, "--") == 0;
+        std::size_t equals = is_long ? item.find('=') : std::string_view::npos;
+        auto match = names.find(item.substr(0, equals), i, handler);
+        if (not match)
+        {
+            if (not utils::is_shell_argument(item))
+            {
+                handler.positional(item, i);
+            }
+            continue;
+        }
+
+        if (equals != std::string_view::npos)
+        {
+            std::string_view value = item.substr(equals + 1);
+            if (match->num_values == 0)
+            {
+                handler.error({.code = ErrorCode::InvalidValue,
+                               .name = names.long_name(match->id),
+                               .token_index = i,
+                               .value = value});
+                continue;
+            }
+            i = extract_option(cmd_line, i, *match, handler, value);
+            continue;
+        }
+
+        if (match->num_values == 0)
+        {
+            handler.flag(match->id);
+            continue;
+        }
+        i = extract_option(cmd_line, i, *match, handler);
+    }
+}
+
+}  // namespace cppargs::tokenizer
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace cppargs {
+
+// Prefix tree mapping words to values. Children are kept sorted by letter, so
+// words sharing a prefix are visited in lexicographic order.
+class Trie
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // a word inserted again gets the new value
+    void insert(std::string_view word, std::size_t value)
+    {
+        std::uint32_t node = 0;
+        for (char letter : word)
+        {
+            node = child_or_insert(node, letter);
+        }
+        bool is_new_word = nodes[node].value == npos;
+        nodes[node].value = value;
+
+        if (is_new_word)
+        {
+            node = 0;
+            nodes[node].num_words++;
+            for (char letter : word)
+            {
+                node = child(node, letter);
+                nodes[node].num_words++;
+            }
+        }
+    }
+
+    void reserve(std::size_t num_nodes) { nodes.reserve(num_nodes); }
+    bool empty() const { return nodes.size() == 1; }
+
+    // value of the word, npos if it was not inserted
+    std::size_t find(std::string_view word) const
+    {
+        std::uint32_t node = node_of(word);
+        return node == not_found ? npos : nodes[node].value;
+    }
+
+    std::size_t num_words_with_prefix(std::string_view prefix) const
+    {
+        std::uint32_t node = node_of(prefix);
+        return node == not_found ? 0 : nodes[node].num_words;
+    }
+
+    // value of the only word starting with prefix, npos if there are none or
+    // several
+    std::size_t find_unique(std::string_view prefix) const
+    {
+        std::uint32_t node = node_of(prefix);
+        if (node == not_found or nodes[node].num_words != 1)
+        {
+            return npos;
+        }
+        while (nodes[node].value == npos)
+        {
+            node = nodes[node].first_child;
+        }
+        return nodes[node].value;
+    }
+
+    // calls visit(value) for every word starting with prefix
+    template <typename Visitor>
+    void visit_prefix(std::string_view prefix, Visitor &&visit) const
+    {
+        std::uint32_t node = node_of(prefix);
+        if (node != not_found)
+        {
+            visit_subtree(node, visit);
+        }
+    }
+
+private:
+    static constexpr std::uint32_t none = 0;
+    static constexpr std::uint32_t not_found = static_cast<std::uint32_t>(-1);
+
+    struct Node
+    {
+        // 0 (the root) for no child / sibling
+        std::uint32_t first_child = none;
+        std::uint32_t next_sibling = none;
+        std::size_t value = npos;
+        // words ending in this node or below
+        std::uint32_t num_words = 0;
+        char letter = '\0';
+    };
+    std::vector<Node> nodes = {Node{}};
+
+    std::uint32_t child(std::uint32_t node, char letter) const
+    {
+        for (std::uint32_t c = nodes[node].first_child; c != none;
+             c = nodes[c].next_sibling)
+        {
+            if (nodes[c].letter == letter)
+            {
+                return c;
+            }
+            if (nodes[c].letter > letter)
+            {
+                break;
+            }
+        }
+        return none;
+    }
+
+    std::uint32_t child_or_insert(std::uint32_t node, char letter)
+    {
+        std::uint32_t previous = none;
+        std::uint32_t c = nodes[node].first_child;
+        for (; c != none and nodes[c].letter < letter;
+             c = nodes[c].next_sibling)
+        {
+            previous = c;
+        }
+        if (c != none and nodes[c].letter == letter)
+        {
+            return c;
+        }
+
+        auto inserted = static_cast<std::uint32_t>(nodes.size());
+        nodes.push_back({.next_sibling = c, .letter = letter});
+        if (previous == none)
+        {
+            nodes[node].first_child = inserted;
+        } else
+        {
+            nodes[previous].next_sibling = inserted;
+        }
+        return inserted;
+    }
+
+    // not_found if no word starts with prefix (the root stands for "")
+    std::uint32_t node_of(std::string_view prefix) const
+    {
+        std::uint32_t node = 0;
+        for (char letter : prefix)
+        {
+            node = child(node, letter);
+            if (node == none)
+            {
+                return not_found;
+            }
+        }
+        return node;
+    }
+
+    template <typename Visitor>
+    void visit_subtree(std::uint32_t node, Visitor &visit) const
+    {
+        if (nodes[node].value != npos)
+        {
+            visit(nodes[node].value);
+        }
+        for (std::uint32_t c = nodes[node].first_child; c != none;
+             c = nodes[c].next_sibling)
+        {
+            visit_subtree(c, visit);
+        }
+    }
+};
+
+}  // namespace cppargs
@@ -1,16 +1,74 @@
-#include <regex>
-#include <sstream>
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "CmdLine.h"
+#include "Converter.h"
 
 namespace cppargs::utils {
 
 template <typename T>
-T convert_value(std::string source_value)
+bool convert_value(std::string_view source_value, T &converted_value)
 {
-    T converted_value;
-    std::stringstream ss;
-    ss << source_value;
-    ss >> converted_value;
+    return Converter<T>::convert(source_value, converted_value);
+}
+
+// T{} if the value cannot be converted
+template <typename T>
+T convert_value(std::string_view source_value)
+{
+    T converted_value{};
+    convert_value(source_value, converted_value);
     return converted_value;
 }
 
+inline bool is_letter(char c)
+{
+    return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z');
+}
+
+// "--" or a dash (or two) followed by letters only, e.g. "-xvf", "--foo". A
+// lone "-" (stdin) and negative numbers are not.
+inline bool is_shell_argument(std::string_view str)
+{
+    if (str.size() < 2 or str[0] != '-')
+    {
+        return false;
+    }
+    std::size_t i = (str.size() > 1 and str[1] == '-') ? 2 : 1;
+    for (; i < str.size(); i++)
+    {
+        if (not is_letter(str[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// true if the defined number of values follows position on the command line
+// and none of them looks like an option
+inline bool is_num_values_correct(int defined_num_values, std::size_t position,
+                                  const CmdLine &cmd_line)
+{
+    if (position + defined_num_values >= cmd_line.size())
+    {
+        return false;
+    }
+    for (int i = 1; i <= defined_num_values; i++)
+    {
+        if (is_shell_argument(cmd_line[position + i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::string short_name_string(char short_name)
+{
+    return short_name == '\0' ? std::string() : std::string(1, short_name);
+}
+
 }  // namespace cppargs::utils
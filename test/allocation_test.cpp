@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+
+#include "Parser.h"
+
+using namespace cppargs;
+
+namespace {
+
+// allocations made with the global operator new while counting
+std::size_t num_allocations = 0;
+bool is_counting = false;
+
+template <typename Function>
+std::size_t count_allocations(Function &&function)
+{
+    num_allocations = 0;
+    is_counting = true;
+    function();
+    is_counting = false;
+    return num_allocations;
+}
+
+}  // namespace
+
+void *operator new(std::size_t size)
+{
+    if (is_counting)
+    {
+        num_allocations++;
+    }
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC pairs the replaced operator new with free
+#if defined(__GNUC__) and not defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// a bit of everything, with typed values
+struct Program
+{
+    Parser parser;
+    FlagHandle verbose;
+    OptionHandle<int> jobs;
+    OptionHandle<std::string> output;
+    VecOptionHandle<double> size;
+    PositionalHandle<std::string> input;
+
+    Program()
+    {
+        parser.set_error_sink(nullptr);
+        verbose = parser.add_flag('v', "verbose", "print more");
+        parser.add_flag('x', "extract", "extract files");
+        jobs = parser.add_option<int>('j', "jobs", "number of jobs", false,
+                                      "1");
+        output = parser.add_option<std::string>('o', "output", "output file",
+                                                false, "");
+        parser.add_option("level", "compression level", false, "6");
+        size = parser.add_vec_option<double>("size", "width and height", 2,
+                                             false);
+        input = parser.add_positional<std::string>("input", "input file");
+        parser.add_subcommand("run", "run it", [](Parser &run) {
+            run.add_option("threads", "number of threads", false, "1");
+        });
+    }
+};
+
+}  // namespace
+
+TEST(AllocationTest, ParseIntoArgsAfterWarmUp)
+{
+    Program program;
+    const Parser &parser = program.parser;
+    std::vector<std::string> cmd_line = {
+        "/usr/local/bin/a-rather-long-program-name",
+        "-xv",
+        "-j8",
+        "--output=/tmp/a-rather-long-output-file-name.tar",
+        "--level",
+        "9",
+        "--size",
+        "1.5",
+        "2.5",
+        "/tmp/a-rather-long-input-file-name.txt",
+        "--",
+        "-extra"};
+
+    Args args;
+    parser.parse_args(cmd_line, args);
+    EXPECT_EQ(count_allocations([&] { parser.parse_args(cmd_line, args); }),
+              0);
+
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args[program.verbose]);
+    EXPECT_EQ(args[program.jobs], 8);
+    EXPECT_EQ(args[program.output],
+              "/tmp/a-rather-long-output-file-name.tar");
+    EXPECT_EQ(args[program.size], std::vector<double>({1.5, 2.5}));
+    EXPECT_EQ(args[program.input],
+              "/tmp/a-rather-long-input-file-name.txt");
+    EXPECT_EQ(args.num_positionals(), 2);
+
+    // a shorter command line fits too
+    std::vector<std::string> short_cmd_line = {"prog", "in.txt"};
+    EXPECT_EQ(count_allocations(
+                  [&] { parser.parse_args(short_cmd_line, args); }),
+              0);
+    EXPECT_FALSE(args[program.verbose]);
+    EXPECT_EQ(args[program.jobs], 1);
+    EXPECT_EQ(args[program.output], "");
+}
+
+TEST(AllocationTest, CollectedErrorsAfterWarmUp)
+{
+    Program program;
+    const Parser &parser = program.parser;
+    std::vector<std::string> cmd_line = {"prog", "-xq", "--jobs", "many",
+                                         "--size", "1"};
+
+    Args args;
+    parser.parse_args(cmd_line, args);
+    EXPECT_EQ(count_allocations([&] { parser.parse_args(cmd_line, args); }),
+              0);
+    EXPECT_EQ(args.parse_result().errors().size(), 2);
+}
+
+TEST(AllocationTest, SubcommandAfterWarmUp)
+{
+    Program program;
+    const Parser &parser = program.parser;
+    std::vector<std::string> cmd_line = {"prog", "run", "--threads", "4"};
+
+    Args args;
+    parser.parse_args(cmd_line, args);
+    EXPECT_EQ(count_allocations([&] { parser.parse_args(cmd_line, args); }),
+              0);
+    EXPECT_EQ(args.subcommand(), "run");
+    EXPECT_EQ(args.get_value<int>("threads"), 4);
+}
+
+TEST(AllocationTest, ArenaWithoutWarmUp)
+{
+    // typed values that do not fit into std::any still use the global heap,
+    // so only flags and an int here
+    Parser parser;
+    FlagHandle verbose = parser.add_flag('v', "verbose", "print more");
+    OptionHandle<int> jobs =
+        parser.add_option<int>('j', "jobs", "number of jobs", false, "1");
+    parser.add_option("level", "compression level", false, "6");
+    std::vector<std::string> cmd_line = {"prog", "-v", "--jobs", "3",
+                                         "--level", "1", "in.txt"};
+
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    std::size_t count = count_allocations([&] {
+        Args args = parser.parse_args(cmd_line, &arena);
+        EXPECT_TRUE(args[verbose]);
+        EXPECT_EQ(args[jobs], 3);
+    });
+    EXPECT_EQ(count, 0);
+}
+
+TEST(AllocationTest, ArenaWithErrors)
+{
+    // the program name is longer than fits into a std::string itself
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.collect_all_errors(true);
+    parser.add_option<int>('j', "jobs", "number of jobs", true, "");
+    parser.add_positional("input", "input file");
+    std::vector<std::string> cmd_line = {
+        "/usr/local/bin/a-rather-long-program-name", "--jobs", "many"};
+
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    std::size_t count = count_allocations([&] {
+        Args args = parser.parse_args(cmd_line, &arena);
+        EXPECT_EQ(args.parse_result().errors().size(), 2);
+    });
+    EXPECT_EQ(count, 0);
+}
+
+namespace {
+
+class CountingVisitor : public ArgumentVisitor
+{
+public:
+    std::size_t num_items = 0;
+
+    bool on_flag(ArgumentId) override { return ++num_items != 0; }
+    bool on_option(ArgumentId, std::string_view) override
+    {
+        return ++num_items != 0;
+    }
+    bool on_positional(std::size_t, std::string_view) override
+    {
+        return ++num_items != 0;
+    }
+};
+
+}  // namespace
+
+TEST(AllocationTest, VisitWithoutWarmUp)
+{
+    Program program;
+    std::vector<std::string> cmd_line = {"prog"};
+    for (int i = 0; i < 1000; i++)
+    {
+        cmd_line.insert(cmd_line.end(), {"-xv", "--jobs=4", "file.txt"});
+    }
+
+    CountingVisitor visitor;
+    EXPECT_EQ(count_allocations([&] {
+                  EXPECT_TRUE(program.parser.visit(cmd_line, visitor));
+              }),
+              0);
+    EXPECT_EQ(visitor.num_items, 4000);
+}
@@ -0,0 +1,141 @@
+#include "Parser.h"
+
+#include <gtest/gtest.h>
+
+using namespace cppargs;
+
+namespace {
+
+struct Config
+{
+    bool verbose = false;
+    bool dry_run = true;
+    int threads = 0;
+    double ratio = 0.5;
+    std::string name = "none";
+    std::vector<int> size;
+    std::string input;
+    int count = 0;
+};
+
+struct Service
+{
+    Parser parser;
+
+    Service()
+    {
+        parser.set_error_sink(nullptr);
+        parser.bind_flag(&Config::verbose, 'v', "verbose", "print more");
+        parser.bind_flag(&Config::dry_run, "dry-run", "change nothing");
+        parser.bind_option(&Config::threads, 't', "threads",
+                           "number of threads", false, "4");
+        parser.bind_option(&Config::ratio, "ratio", "compression ratio", false,
+                           "");
+        parser.bind_option(&Config::name, 'n', "name", "service name", false,
+                           "");
+        parser.bind_vec_option(&Config::size, "size", "width and height", 2,
+                               false);
+        parser.bind_positional(&Config::input, "input", "input file");
+        parser.bind_positional(&Config::count, "count", "number of runs");
+    }
+};
+
+}  // namespace
+
+TEST(BindingTest, ValuesAreWrittenToMembers)
+{
+    Service service;
+    Config config;
+
+    std::vector<std::string> cmd_line = {"prog", "-vt8", "--name=web",
+                                         "--size", "640", "480", "in.txt", "3"};
+    ParseResult result = service.parser.parse_args(cmd_line, config);
+
+    EXPECT_FALSE(result.errors_occured());
+    EXPECT_TRUE(config.verbose);
+    EXPECT_FALSE(config.dry_run);
+    EXPECT_EQ(config.threads, 8);
+    EXPECT_EQ(config.ratio, 0.5);
+    EXPECT_EQ(config.name, "web");
+    EXPECT_EQ(config.size, std::vector<int>({640, 480}));
+    EXPECT_EQ(config.input, "in.txt");
+    EXPECT_EQ(config.count, 3);
+}
+
+TEST(BindingTest, DefaultsAndMembersNotGiven)
+{
+    Service service;
+    Config config;
+    config.size = {1, 2};
+
+    std::vector<std::string> cmd_line = {"prog", "--dry-run", "--size", "3",
+                                         "4", "--size", "5", "6", "in.txt",
+                                         "1"};
+    ParseResult result = service.parser.parse_args(cmd_line, config);
+
+    EXPECT_FALSE(result.errors_occured());
+    EXPECT_FALSE(config.verbose);
+    EXPECT_TRUE(config.dry_run);
+    EXPECT_EQ(config.threads, 4);
+    EXPECT_EQ(config.name, "none");
+    EXPECT_EQ(config.size, std::vector<int>({3, 4, 5, 6}));
+}
+
+TEST(BindingTest, Errors)
+{
+    Service service;
+    service.parser.add_option("mode", "mode", true, "");
+    service.parser.set_choices("name", {"web", "db"});
+    Config config;
+
+    std::vector<std::string> cmd_line = {"prog", "in", "--threads", "many",
+                                         "--name", "mail", "--size"};
+    ParseResult result = service.parser.parse_args(cmd_line, config);
+
+    // as parse_args, without the value that cannot be converted
+    EXPECT_TRUE(result.errors_occured());
+    EXPECT_TRUE(service.parser.errors_occured());
+    ASSERT_EQ(result.errors().size(), 4);
+    EXPECT_EQ(result.errors()[0].value, "mail");
+    EXPECT_EQ(result.errors()[1].code, ErrorCode::InvalidNumOfValues);
+    EXPECT_EQ(result.errors()[2].name, "mode");
+    EXPECT_EQ(result.errors()[3].name, "count");
+    Args args = service.parser.parse_args(cmd_line);
+    EXPECT_EQ(args.parse_result().errors().size(), 4);
+
+    service.parser.collect_all_errors(true);
+    result = service.parser.parse_args(cmd_line, config);
+    ASSERT_EQ(result.errors().size(), 5);
+    EXPECT_EQ(result.errors()[0].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(result.errors()[0].value, "many");
+    EXPECT_EQ(result.errors()[1].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(result.errors()[1].value, "mail");
+    EXPECT_EQ(result.errors()[2].code, ErrorCode::InvalidNumOfValues);
+    EXPECT_EQ(result.errors()[3].code, ErrorCode::OptionRequired);
+    EXPECT_EQ(result.errors()[3].name, "mode");
+    EXPECT_EQ(result.errors()[4].code, ErrorCode::PositionalRequired);
+    EXPECT_EQ(result.errors()[4].name, "count");
+    EXPECT_EQ(config.name, "none");
+}
+
+TEST(BindingTest, OnlyMembersOfTheBoundStruct)
+{
+    struct Other
+    {
+        int threads = 0;
+    };
+    Service service;
+    service.parser.bind_option(&Other::threads, "other-threads",
+                               "number of threads", false, "");
+    Config config;
+    Other other;
+
+    std::vector<std::string> cmd_line = {"prog", "-t", "2", "--other-threads",
+                                         "3", "in", "1"};
+    service.parser.parse_args(cmd_line, config);
+    EXPECT_EQ(config.threads, 2);
+    EXPECT_EQ(other.threads, 0);
+
+    service.parser.parse_args(cmd_line, other);
+    EXPECT_EQ(other.threads, 3);
+}
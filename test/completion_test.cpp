@@ -0,0 +1,151 @@
+#include "Parser.h"
+
+#include <gtest/gtest.h>
+
+using namespace cppargs;
+
+namespace {
+
+using Words = std::vector<std::string_view>;
+
+struct Tool
+{
+    Parser parser;
+    int num_commit_builds = 0;
+
+    Tool()
+    {
+        parser.add_flag('v', "verbose", "verbose");
+        parser.add_flag("version", "print version");
+        parser.add_option('f', "format", "output format", false, "");
+        parser.set_choices("format", {"json", "yaml", "yml"});
+        parser.add_option("output", "output file", false, "");
+        parser.add_subcommand("commit", "record changes", [this](Parser &p) {
+            num_commit_builds++;
+            p.add_flag('a', "amend", "amend");
+            p.add_flag("all", "all files");
+        });
+        parser.add_subcommand("config", "settings", {});
+    }
+};
+
+}  // namespace
+
+TEST(CompletionTest, LongNames)
+{
+    Tool tool;
+
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "--ver"}, 1),
+              Words({"--verbose", "--version"}));
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "x", "--o"}, 2),
+              Words({"--output"}));
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "-"}, 1),
+              Words({"--format", "--help", "--output", "--verbose",
+                     "--version", "-f", "-h", "-v"}));
+    EXPECT_TRUE(tool.parser.complete(Words{"tool", "--x"}, 1).empty());
+}
+
+TEST(CompletionTest, Choices)
+{
+    Tool tool;
+
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "--format", "y"}, 2),
+              Words({"yaml", "yml"}));
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "-f"}, 2),
+              Words({"json", "yaml", "yml"}));
+    // values of options without choices are left to the shell
+    EXPECT_TRUE(
+        tool.parser.complete(Words{"tool", "--output", "-"}, 2).empty());
+}
+
+TEST(CompletionTest, Subcommands)
+{
+    Tool tool;
+
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "co"}, 1),
+              Words({"commit", "config"}));
+    EXPECT_EQ(tool.num_commit_builds, 0);
+
+    EXPECT_EQ(tool.parser.complete(Words{"tool", "commit", "--a"}, 2),
+              Words({"--all", "--amend"}));
+    EXPECT_EQ(tool.num_commit_builds, 1);
+    EXPECT_TRUE(tool.parser.complete(Words{"tool", "x", "co"}, 2).empty());
+}
+
+TEST(CompletionTest, HiddenCommand)
+{
+    Tool tool;
+
+    std::vector<std::string> cmd_line = {"tool", "__complete", "2",
+                                         "tool", "-f", "j"};
+    testing::internal::CaptureStdout();
+    Args args = tool.parser.parse_args(cmd_line);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    EXPECT_EQ(output, "json\n");
+    EXPECT_TRUE(args.parse_result().completion_requested());
+    EXPECT_FALSE(args.errors_occured());
+}
+
+TEST(CompletionTest, HiddenCommandScansDefinitions)
+{
+    Tool tool;
+
+    for (Words words : {Words{"tool", "-"}, Words{"tool", "--ver"},
+                        Words{"tool", "--"}, Words{"tool", "-v"},
+                        Words{"tool", "c"}, Words{"tool", "--format", "y"},
+                        Words{"tool", "commit", "--a"}, Words{"tool", "x"}})
+    {
+        std::string expected;
+        for (std::string_view candidate :
+             tool.parser.complete(words, words.size() - 1))
+        {
+            expected += std::string(candidate) + "\n";
+        }
+
+        std::vector<std::string> cmd_line = {"tool", "__complete",
+                                             std::to_string(words.size() - 1)};
+        cmd_line.insert(cmd_line.end(), words.begin(), words.end());
+        testing::internal::CaptureStdout();
+        tool.parser.parse_args(cmd_line);
+        EXPECT_EQ(testing::internal::GetCapturedStdout(), expected);
+    }
+}
+
+TEST(CompletionTest, InvalidChoice)
+{
+    Tool tool;
+    tool.parser.set_error_sink(nullptr);
+
+    std::vector<std::string> cmd_line = {"tool", "-f", "xml"};
+    Args args = tool.parser.parse_args(cmd_line);
+
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    EXPECT_EQ(args.parse_result().errors()[0].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(args.parse_result().errors()[0].value, "xml");
+
+    std::vector<std::string> valid_cmd_line = {"tool", "-f", "yml"};
+    args = tool.parser.parse_args(valid_cmd_line);
+    EXPECT_FALSE(args.errors_occured());
+
+    tool.parser.set_choices("verbose", {"a"});
+    EXPECT_EQ(tool.parser.definition_errors().errors()[0].code,
+              ErrorCode::UnknownOption);
+}
+
+TEST(CompletionTest, Scripts)
+{
+    std::string bash =
+        Parser::completion_script(Shell::Bash, "/usr/bin/my-tool");
+    EXPECT_NE(bash.find("_my_tool_complete()"), std::string::npos);
+    EXPECT_NE(bash.find("complete -o default -F _my_tool_complete my-tool"),
+              std::string::npos);
+
+    std::string zsh = Parser::completion_script(Shell::Zsh, "my-tool");
+    EXPECT_EQ(zsh.rfind("#compdef my-tool\n", 0), 0);
+    EXPECT_NE(zsh.find("__complete $((CURRENT - 1))"), std::string::npos);
+
+    std::string fish = Parser::completion_script(Shell::Fish, "my-tool");
+    EXPECT_NE(fish.find("complete -c my-tool -a '(_my_tool_complete)'"),
+              std::string::npos);
+}
@@ -0,0 +1,159 @@
+#include "Converter.h"
+
+#include <gtest/gtest.h>
+
+#include <istream>
+
+#include "ErrorMessages.h"
+#include "Parser.h"
+#include "utils.h"
+
+using namespace cppargs;
+
+struct Point
+{
+    int x = 0, y = 0;
+};
+
+template <>
+struct cppargs::Converter<Point>
+{
+    static bool convert(std::string_view source, Point &value)
+    {
+        std::size_t comma = source.find(',');
+        return comma != std::string_view::npos and
+               utils::convert_value(source.substr(0, comma), value.x) and
+               utils::convert_value(source.substr(comma + 1), value.y);
+    }
+};
+
+// read with operator>>, there is no Converter specialization
+struct Size
+{
+    int width = 0, height = 0;
+};
+
+std::istream &operator>>(std::istream &stream, Size &size)
+{
+    char x = '\0';
+    stream >> size.width >> x >> size.height;
+    if (x != 'x')
+    {
+        stream.setstate(std::ios::failbit);
+    }
+    return stream;
+}
+
+TEST(ConverterTest, Integers)
+{
+    int i = 0;
+    EXPECT_TRUE(utils::convert_value("-42", i));
+    EXPECT_EQ(-42, i);
+    EXPECT_TRUE(utils::convert_value("+7", i));
+    EXPECT_EQ(7, i);
+
+    EXPECT_FALSE(utils::convert_value("12abc", i));
+    EXPECT_FALSE(utils::convert_value("", i));
+    EXPECT_FALSE(utils::convert_value("99999999999", i));
+    EXPECT_EQ(7, i);
+
+    unsigned u = 0;
+    EXPECT_FALSE(utils::convert_value("-1", u));
+    EXPECT_EQ(123456789012345LL,
+              utils::convert_value<long long>("123456789012345"));
+}
+
+TEST(ConverterTest, FloatingPoint)
+{
+    EXPECT_DOUBLE_EQ(-1.5e3, utils::convert_value<double>("-1.5e3"));
+    EXPECT_FLOAT_EQ(0.25f, utils::convert_value<float>(".25"));
+
+    double d = 1.0;
+    EXPECT_FALSE(utils::convert_value("1.5.2", d));
+    EXPECT_DOUBLE_EQ(1.0, d);
+}
+
+TEST(ConverterTest, StringsBoolsAndChars)
+{
+    std::string_view source = "some text";
+    EXPECT_EQ(source.data(),
+              utils::convert_value<std::string_view>(source).data());
+    EXPECT_EQ("some text", utils::convert_value<std::string>(source));
+
+    EXPECT_TRUE(utils::convert_value<bool>("true"));
+    EXPECT_FALSE(utils::convert_value<bool>("0"));
+    bool b = false;
+    EXPECT_FALSE(utils::convert_value("yes", b));
+
+    EXPECT_EQ('x', utils::convert_value<char>("x"));
+}
+
+TEST(ConverterTest, UserType)
+{
+    Point p = utils::convert_value<Point>("3,-4");
+    EXPECT_EQ(3, p.x);
+    EXPECT_EQ(-4, p.y);
+}
+
+TEST(ConverterTest, StreamFallback)
+{
+    Size size = utils::convert_value<Size>("640x480");
+    EXPECT_EQ(640, size.width);
+    EXPECT_EQ(480, size.height);
+
+    EXPECT_FALSE(utils::convert_value("640x480px", size));
+    EXPECT_FALSE(utils::convert_value("640", size));
+    EXPECT_EQ(640, size.width);
+}
+
+TEST(ConverterTest, InvalidValueOfTypedHandle)
+{
+    testing::internal::CaptureStderr();
+    Parser parser;
+    OptionHandle<int> num = parser.add_option<int>('n', "num", "", false, "1");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-n", "abc"};
+
+    Args args = parser.parse_args(cmd_line);
+    std::string captured_error = testing::internal::GetCapturedStderr();
+
+    EXPECT_STREQ(ErrorMessages::invalid_value("num", "abc").c_str(),
+                 captured_error.c_str());
+    EXPECT_TRUE(parser.errors_occured());
+    EXPECT_EQ(0, args[num]);
+}
+
+TEST(ConverterTest, InvalidValueOfGetValue)
+{
+    Parser parser;
+    parser.add_option('n', "num", "", false, "1");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-n", "1.5"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    ParseResult errors;
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(0, args.get_value<int>("num", &errors));
+    EXPECT_EQ("", testing::internal::GetCapturedStderr());
+
+    EXPECT_STREQ(ErrorMessages::invalid_value("num", "1.5").c_str(),
+                 errors.messages().c_str());
+    EXPECT_DOUBLE_EQ(1.5, args.get_value<double>("num", &errors));
+    EXPECT_EQ(1, errors.errors().size());
+
+    // without a ParseResult the error goes to the sink of the parser
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(0, args.get_value<int>("num"));
+    EXPECT_EQ(ErrorMessages::invalid_value("num", "1.5"),
+              testing::internal::GetCapturedStderr());
+
+    std::vector<std::string> messages;
+    parser.set_error_sink(
+        [&](const std::string &message) { messages.push_back(message); });
+    args = parser.parse_args(cmd_line);
+    EXPECT_EQ(std::vector<int>(), args.get_vec_values<int>("missing"));
+    EXPECT_EQ(std::vector<std::string>(
+                  {ErrorMessages::option_not_given("missing")}),
+              messages);
+}
@@ -0,0 +1,156 @@
+#include "ParseResult.h"
+
+#include <gtest/gtest.h>
+
+#include "Parser.h"
+
+using namespace cppargs;
+
+TEST(ParseResultTest, CollectsAllErrors)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.collect_all_errors(true);
+    parser.add_option('o', "output", "output file", true, "");
+    parser.add_vec_option('p', "point", "point", 3, false);
+    parser.add_option<int>('n', "num", "number", false, "");
+    parser.add_positional("input", "input file");
+
+    testing::internal::CaptureStderr();
+    testing::internal::CaptureStdout();
+    std::vector<std::string> cmd_line = {"prog", "-n", "abc", "-p"};
+    Args args = parser.parse_args(cmd_line);
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "");
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+    EXPECT_TRUE(parser.errors_occured());
+    EXPECT_TRUE(args.errors_occured());
+    EXPECT_FALSE(args["num"]);
+
+    std::span<const ParseError> errors = args.parse_result().errors();
+    ASSERT_EQ(errors.size(), 4);
+    EXPECT_EQ(errors[0].code, ErrorCode::OptionRequired);
+    EXPECT_EQ(errors[0].name, "output");
+    EXPECT_EQ(errors[1].code, ErrorCode::InvalidNumOfValues);
+    EXPECT_EQ(errors[1].name, "point");
+    EXPECT_EQ(errors[1].token_index, 3);
+    EXPECT_EQ(errors[1].num_values, 3);
+    EXPECT_EQ(errors[2].code, ErrorCode::PositionalRequired);
+    EXPECT_EQ(errors[2].name, "input");
+    EXPECT_EQ(errors[3].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(errors[3].name, "num");
+    EXPECT_EQ(errors[3].value, "abc");
+
+    EXPECT_EQ(args.parse_result().messages(),
+              ErrorMessages::option_required("output") +
+                  ErrorMessages::invalid_num_of_values("point", 3) +
+                  ErrorMessages::positional_required("input") +
+                  ErrorMessages::invalid_value("num", "abc"));
+}
+
+TEST(ParseResultTest, MissingOptionAndInvalidValue)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_option("req", "required", true, "");
+    parser.add_option<int>('n', "num", "number", false, "");
+
+    std::vector<std::string> cmd_line = {"prog", "-n", "abc"};
+    Args args = parser.parse_args(cmd_line);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    EXPECT_EQ(args.parse_result().errors()[0].code, ErrorCode::OptionRequired);
+
+    parser.collect_all_errors(true);
+    args = parser.parse_args(cmd_line);
+    std::span<const ParseError> errors = args.parse_result().errors();
+    ASSERT_EQ(errors.size(), 2);
+    EXPECT_EQ(errors[0].code, ErrorCode::OptionRequired);
+    EXPECT_EQ(errors[0].name, "req");
+    EXPECT_EQ(errors[1].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(errors[1].name, "num");
+    EXPECT_EQ(errors[1].value, "abc");
+    EXPECT_FALSE(args["num"]);
+}
+
+TEST(ParseResultTest, InvalidValues)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.collect_all_errors(true);
+    parser.add_option<int>('n', "num", "number", false, "");
+    parser.add_option<double>('x', "ratio", "ratio", false, "");
+    parser.add_positional<int>("count", "count");
+    parser.add_option("mode", "mode", false, "");
+    parser.set_choices("mode", {"fast", "slow"});
+
+    std::vector<std::string> cmd_line = {"prog", "-n", "abc", "--mode=x",
+                                         "-x", "1.5e", "many"};
+    Args args = parser.parse_args(cmd_line);
+
+    std::span<const ParseError> errors = args.parse_result().errors();
+    ASSERT_EQ(errors.size(), 4);
+    EXPECT_EQ(errors[0].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(errors[0].name, "mode");
+    EXPECT_EQ(errors[0].value, "x");
+    EXPECT_EQ(errors[0].token_index, 3);
+    EXPECT_EQ(errors[1].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(errors[1].name, "num");
+    EXPECT_EQ(errors[1].value, "abc");
+    EXPECT_EQ(errors[1].token_index, 1);
+    EXPECT_EQ(errors[2].name, "ratio");
+    EXPECT_EQ(errors[2].value, "1.5e");
+    EXPECT_EQ(errors[2].token_index, 4);
+    EXPECT_EQ(errors[3].name, "count");
+    EXPECT_EQ(errors[3].value, "many");
+    EXPECT_EQ(errors[3].token_index, 6);
+}
+
+TEST(ParseResultTest, DefinitionErrors)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('f', "foo", "foo");
+    parser.add_flag('f', "bar", "bar");
+    parser.add_option("x", "too short", false, "");
+    parser.add_option<int>("num", "number", false, "abc");
+
+    std::span<const ParseError> errors = parser.definition_errors().errors();
+    ASSERT_EQ(errors.size(), 3);
+    EXPECT_EQ(errors[0].code, ErrorCode::ShortNameTaken);
+    EXPECT_EQ(errors[0].short_name, 'f');
+    EXPECT_EQ(errors[1].code, ErrorCode::LongNameTooShort);
+    EXPECT_EQ(errors[1].name, "x");
+    EXPECT_EQ(errors[2].code, ErrorCode::InvalidValue);
+    EXPECT_EQ(errors[2].value, "abc");
+
+    std::vector<std::string> cmd_line = {"prog", "-f"};
+    Args args = parser.parse_args(cmd_line);
+    EXPECT_FALSE(args["foo"]);
+    EXPECT_EQ(args.parse_result().errors().size(), 3);
+}
+
+TEST(ParseResultTest, ErrorSink)
+{
+    Parser parser;
+    std::vector<std::string> messages;
+    parser.set_error_sink(
+        [&](const std::string &message) { messages.push_back(message); });
+    parser.add_option('o', "output", "output file", true, "");
+    parser.add_option('i', "input", "input file", true, "");
+
+    testing::internal::CaptureStderr();
+    std::vector<std::string> cmd_line = {"prog"};
+    parser.parse_args(cmd_line);
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "");
+
+    // the first error of a group stops its validation
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0], ErrorMessages::option_required("output"));
+
+    messages.clear();
+    parser.collect_all_errors(true);
+    Args args = parser.parse_args(cmd_line);
+    ASSERT_EQ(messages.size(), 2);
+    EXPECT_EQ(messages[1], ErrorMessages::option_required("input"));
+    EXPECT_EQ(args.parse_result().errors().size(), 2);
+}
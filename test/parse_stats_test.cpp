@@ -0,0 +1,81 @@
+#include "ParseStats.h"
+
+#include <gtest/gtest.h>
+
+#include "Parser.h"
+
+using namespace cppargs;
+
+namespace {
+
+class StatsCollector : public ParseObserver
+{
+public:
+    void on_parse(const ParseStats &parse_stats) override
+    {
+        stats = parse_stats;
+        num_parses++;
+    }
+
+    std::size_t allocation_count() const override { return allocations += 10; }
+
+    ParseStats stats;
+    int num_parses = 0;
+    mutable std::size_t allocations = 0;
+};
+
+}  // namespace
+
+TEST(ParseStatsTest, Observer)
+{
+    Parser parser;
+    parser.add_flag('a', "foo", "a flag");
+    parser.add_flag('b', "bar", "a flag");
+    OptionHandle<int> num = parser.add_option<int>('n', "num", "", false, "1");
+
+    StatsCollector collector;
+    parser.set_observer(&collector);
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-ab", "--num", "3",
+                                         "file"};
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_EQ(3, args[num]);
+    EXPECT_EQ(1, collector.num_parses);
+    EXPECT_EQ(4, collector.stats.tokens_examined);
+    // two letters of the cluster, "--num" and "file"
+    EXPECT_EQ(4, collector.stats.matcher_invocations);
+    EXPECT_EQ(1, collector.stats.values_converted);
+    EXPECT_EQ(10, collector.stats.allocations);
+    EXPECT_GT(collector.stats.time(ParsePhase::Tokenize).count(), 0);
+
+    parser.set_observer(nullptr);
+    parser.parse_args(cmd_line);
+    EXPECT_EQ(1, collector.num_parses);
+}
+
+TEST(ParseStatsTest, ObserverOfBinding)
+{
+    struct Config
+    {
+        bool verbose = false;
+        int num = 0;
+    };
+    Parser parser;
+    parser.bind_flag(&Config::verbose, 'v', "verbose", "a flag");
+    parser.bind_option(&Config::num, 'n', "num", "", false, "1");
+
+    StatsCollector collector;
+    parser.set_observer(&collector);
+
+    Config config;
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-v", "--num", "3"};
+    parser.parse_args(cmd_line, config);
+
+    EXPECT_EQ(3, config.num);
+    EXPECT_EQ(1, collector.num_parses);
+    EXPECT_EQ(3, collector.stats.tokens_examined);
+    EXPECT_EQ(2, collector.stats.matcher_invocations);
+    EXPECT_EQ(1, collector.stats.values_converted);
+    EXPECT_EQ(10, collector.stats.allocations);
+}
@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <memory_resource>
+#include <thread>
+
 #include "ErrorMessages.h"
 
 using namespace cppargs;
@@ -386,12 +389,12 @@ TEST(ParserTest, PositionalArguments)
     EXPECT_STREQ(second_positional.c_str(),
                  args.get_positional<std::string>("output").c_str());
 
-    testing::internal::CaptureStderr();
-    auto foo = args.get_positional<int>("foo");
-    std::string captured_error = testing::internal::GetCapturedStderr();
-
+    ParseResult errors;
+    EXPECT_EQ(0, args.get_positional<int>("foo", &errors));
+    ASSERT_EQ(1, errors.errors().size());
+    EXPECT_EQ(ErrorCode::PositionalNotGiven, errors.errors()[0].code);
     EXPECT_STREQ(ErrorMessages::positional_not_given("foo").c_str(),
-                 captured_error.c_str());
+                 errors.messages().c_str());
 
     EXPECT_FALSE(parser.errors_occured());
 }
@@ -422,3 +425,601 @@ TEST(ParserTest, PositionalSpecifiedNotGiven)
 }
 
 // OptionAlreadySpecified
+
+TEST(ParserTest, LongNamesAreMatchedLiterally)
+{
+    Parser parser;
+    parser.add_flag("c++", "c++ flag");
+    parser.add_flag("a.b", "a.b flag");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "--cc", "--aXb"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_FALSE(args["c++"]);
+    EXPECT_FALSE(args["a.b"]);
+
+    cmd_line = {"cppargsTEST", "--c++", "--a.b"};
+    args = parser.parse_args(cmd_line);
+
+    EXPECT_TRUE(args["c++"]);
+    EXPECT_TRUE(args["a.b"]);
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, LongNamesOnly)
+{
+    Parser parser;
+    parser.add_flag("foo", "foo flag");
+    parser.add_flag("bar", "bar flag");
+    parser.add_option("baz", "baz option", false, "42");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "--bar", "--baz", "7"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_FALSE(args["foo"]);
+    EXPECT_TRUE(args["bar"]);
+    EXPECT_EQ(7, args.get_value<int>("baz"));
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, RepeatedOptions)
+{
+    Parser parser;
+    parser.add_option('o', "opt", "an option", false, "");
+    parser.add_vec_option('v', "vec", "a vector option", 2, false);
+    parser.add_flag('f', "foo", "a flag");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-o", "1", "first",
+                                         "--vec", "1", "2", "-f",
+                                         "--opt", "2", "-v", "3", "4",
+                                         "second"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_EQ(2, args.get_value<int>("opt"));
+    EXPECT_EQ(std::vector<int>({1, 2, 3, 4}), args.get_vec_values<int>("vec"));
+    EXPECT_TRUE(args["foo"]);
+    EXPECT_EQ(std::vector<std::string>({"first", "second"}),
+              args.get_all_positionals<std::string>());
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, ValuesPointIntoCmdLine)
+{
+    Parser parser;
+    parser.add_option('o', "opt", "an option", false, "");
+    parser.add_vec_option('v', "vec", "a vector option", 2, false);
+    parser.add_positional("input", "input file");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-o", "value",
+                                         "in.txt", "-v", "a", "b"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_EQ(cmd_line[2].data(),
+              args.get_value<std::string_view>("opt").data());
+    EXPECT_EQ(cmd_line[3].data(),
+              args.get_positional<std::string_view>("input").data());
+    EXPECT_EQ(cmd_line[6].data(),
+              args.get_vec_values<std::string_view>("vec").at(1).data());
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, ArgsKeepTheirNamesWhenParserChanges)
+{
+    Parser parser;
+    parser.add_flag('f', "foo", "a flag");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-f", "--bar"};
+
+    Args args = parser.parse_args(cmd_line);
+    parser.add_flag('b', "bar", "another flag");
+
+    EXPECT_TRUE(args["foo"]);
+    EXPECT_FALSE(args["bar"]);
+    EXPECT_FALSE(args["b"]);
+
+    Args other_args = parser.parse_args(cmd_line);
+    EXPECT_TRUE(other_args["bar"]);
+    EXPECT_TRUE(other_args[std::string_view("b")]);
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, TypedHandles)
+{
+    Parser parser;
+    FlagHandle verbose = parser.add_flag('v', "verbose", "a flag");
+    FlagHandle quiet = parser.add_flag('q', "quiet", "a flag");
+    OptionHandle<int> num = parser.add_option<int>('n', "num", "", false, "1");
+    OptionHandle<double> scale =
+        parser.add_option<double>("scale", "", false, "0.5");
+    VecOptionHandle<double> pos =
+        parser.add_vec_option<double>('p', "pos", "", 3, false);
+    PositionalHandle<std::string> input =
+        parser.add_positional<std::string>("input", "");
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-v", "in.txt", "-n",
+                                         "12", "-p", "1", "2", "3"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_TRUE(args[verbose]);
+    EXPECT_FALSE(args[quiet]);
+    EXPECT_EQ(12, args[num]);
+    EXPECT_DOUBLE_EQ(0.5, args[scale]);
+    EXPECT_EQ(std::vector<double>({1.0, 2.0, 3.0}), args[pos]);
+    EXPECT_EQ("in.txt", args[input]);
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, TypedHandleOfRejectedDefinition)
+{
+    testing::internal::CaptureStderr();
+    Parser parser;
+    parser.add_flag('n', "foo", "a flag");
+    OptionHandle<int> num = parser.add_option<int>('n', "num", "", false, "1");
+    testing::internal::GetCapturedStderr();
+
+    EXPECT_FALSE(num.is_valid());
+    EXPECT_TRUE(parser.errors_occured());
+}
+
+TEST(ParserTest, BulkRegistration)
+{
+    Parser parser;
+
+    std::vector<FlagSpec> flags = {{'v', "verbose", "a flag"},
+                                   {'\0', "dry-run", "another flag"}};
+    std::vector<OptionSpec> options = {
+        {'n', "num", "an option", false, "1"},
+        {'\0', "output", "a required option", true, ""},
+        {'p', "pos", "a vector option", false, "", 3}};
+
+    parser.add_flags(flags);
+    parser.add_options(options);
+
+    std::vector<std::string> cmd_line = {"cppargsTEST", "--output", "out.txt",
+                                         "-v",          "-p",       "1",
+                                         "2",           "3"};
+
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_FALSE(args["dry-run"]);
+    EXPECT_EQ(1, args.get_value<int>("num"));
+    EXPECT_EQ("out.txt", args.get_value<std::string>("output"));
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), args.get_vec_values<int>("pos"));
+
+    EXPECT_FALSE(parser.errors_occured());
+}
+
+TEST(ParserTest, BulkRegistrationDuplicateInBatch)
+{
+    testing::internal::CaptureStderr();
+    Parser parser;
+
+    std::vector<OptionSpec> options = {{'n', "num", "an option", false, "1"},
+                                       {'m', "num", "same name", false, "2"}};
+    parser.add_options(options);
+
+    std::string captured_error = testing::internal::GetCapturedStderr();
+
+    EXPECT_STREQ(ErrorMessages::long_name_taken("num").c_str(),
+                 captured_error.c_str());
+    EXPECT_TRUE(parser.errors_occured());
+}
+
+TEST(ParserTest, ParseAfterFailedParse)
+{
+    Parser parser;
+    parser.add_option<int>('n', "num", "number", true, "");
+
+    std::vector<std::string> failing_cmd_line = {"prog"};
+    std::vector<std::string> cmd_line = {"prog", "-n", "3"};
+
+    testing::internal::CaptureStderr();
+    Args failed_args = parser.parse_args(failing_cmd_line);
+    testing::internal::GetCapturedStderr();
+    EXPECT_TRUE(failed_args.errors_occured());
+    EXPECT_TRUE(parser.errors_occured());
+
+    Args args = parser.parse_args(cmd_line);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_FALSE(parser.errors_occured());
+    EXPECT_EQ(args.get_value<int>("num"), 3);
+    EXPECT_TRUE(failed_args.errors_occured());
+}
+
+TEST(ParserTest, ConcurrentParsing)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('v', "verbose", "verbose");
+    OptionHandle<int> num =
+        parser.add_option<int>('n', "num", "number", true, "");
+    parser.add_positional("input", "input file");
+
+    const Parser &shared_parser = parser;
+    std::vector<int> num_correct(8, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++)
+    {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 200; i++)
+            {
+                std::string value = std::to_string(t * 1000 + i);
+                bool is_valid = i % 2 == 0;
+                std::vector<std::string> cmd_line = {"prog", "-n", value};
+                if (is_valid)
+                {
+                    cmd_line.push_back("-v");
+                    cmd_line.push_back("in");
+                }
+
+                Args args = shared_parser.parse_args(cmd_line);
+                if (is_valid and not args.errors_occured() and
+                    args["verbose"] and args[num] == t * 1000 + i and
+                    args.get_positional<std::string>("input") == "in")
+                {
+                    num_correct[t]++;
+                }
+                if (not is_valid and args.errors_occured() and
+                    args.parse_result().errors()[0].code ==
+                        ErrorCode::PositionalRequired)
+                {
+                    num_correct[t]++;
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(num_correct, std::vector<int>(8, 200));
+}
+
+TEST(ParserTest, ConcurrentAbbreviations)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.allow_abbreviations();
+    parser.add_flag('v', "verbose", "verbose");
+    OptionHandle<int> num =
+        parser.add_option<int>('n', "number", "number", true, "");
+
+    // the first parses build the prefix index while the others read it
+    std::vector<std::string> values;
+    std::vector<std::vector<std::string_view>> cmd_lines;
+    for (int i = 0; i < 1000; i++)
+    {
+        values.push_back(std::to_string(i));
+    }
+    for (int i = 0; i < 1000; i++)
+    {
+        cmd_lines.push_back({"prog", "--verb", "--num", values[i]});
+    }
+
+    std::vector<Args> results = parser.parse_batch(cmd_lines, 8);
+    for (int i = 0; i < 1000; i++)
+    {
+        EXPECT_FALSE(results[i].errors_occured());
+        EXPECT_TRUE(results[i]["verbose"]);
+        EXPECT_EQ(results[i][num], i);
+    }
+
+    // a new definition drops the index
+    parser.add_flag("version", "version");
+    std::vector<std::string> ambiguous = {"prog", "--ver", "--num", "1"};
+    Args args = parser.parse_args(ambiguous);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    EXPECT_EQ(args.parse_result().errors()[0].code,
+              ErrorCode::AmbiguousOption);
+}
+
+TEST(ParserTest, ParseBatch)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    OptionHandle<int> num =
+        parser.add_option<int>('n', "num", "number", true, "");
+
+    std::vector<std::string> values;
+    for (int i = 0; i < 1000; i++)
+    {
+        values.push_back(std::to_string(i));
+    }
+    std::vector<std::vector<std::string_view>> cmd_lines;
+    for (int i = 0; i < 1000; i++)
+    {
+        if (i % 10 == 0)
+        {
+            cmd_lines.push_back({"prog"});
+        } else
+        {
+            cmd_lines.push_back({"prog", "-n", values[i]});
+        }
+    }
+
+    std::vector<Args> results = parser.parse_batch(cmd_lines, 4);
+
+    ASSERT_EQ(results.size(), cmd_lines.size());
+    for (int i = 0; i < 1000; i++)
+    {
+        if (i % 10 == 0)
+        {
+            EXPECT_TRUE(results[i].errors_occured());
+        } else
+        {
+            EXPECT_FALSE(results[i].errors_occured());
+            EXPECT_EQ(results[i][num], i);
+        }
+    }
+    EXPECT_TRUE(parser.errors_occured());
+    EXPECT_TRUE(parser.parse_batch({}).empty());
+}
+
+TEST(ParserTest, Abbreviations)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('v', "verbose", "verbose");
+    parser.add_flag("version", "print version");
+    parser.add_option('o', "output", "output file", false, "");
+    parser.add_option("out", "other output", false, "");
+
+    std::vector<std::string> cmd_line = {"prog", "--outp", "file.txt"};
+    std::vector<std::string> abbreviated = {"prog", "--verb", "--outp",
+                                            "file.txt", "--out", "x"};
+    std::vector<std::string> ambiguous = {"prog", "--ver"};
+
+    Args args = parser.parse_args(cmd_line);
+    EXPECT_EQ(args.num_positionals(), 1);
+
+    parser.allow_abbreviations();
+    args = parser.parse_args(abbreviated);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_FALSE(args["version"]);
+    EXPECT_EQ(args.get_value<std::string>("output"), "file.txt");
+    EXPECT_EQ(args.get_value<std::string>("out"), "x");
+
+    args = parser.parse_args(ambiguous);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    const ParseError &error = args.parse_result().errors()[0];
+    EXPECT_EQ(error.code, ErrorCode::AmbiguousOption);
+    EXPECT_EQ(error.name, "ver");
+    EXPECT_EQ(error.token_index, 1);
+}
+
+TEST(ParserTest, ClustersWithOptions)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('x', "extract", "extract");
+    parser.add_flag('v', "verbose", "verbose");
+    parser.add_option('f', "file", "archive", false, "");
+    parser.add_vec_option('s', "size", "width and height", 2, false);
+
+    std::vector<std::string> cmd_line = {"prog", "-xvfarchive.tar", "-vs",
+                                         "3", "4"};
+    Args args = parser.parse_args(cmd_line);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args["extract"]);
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_EQ(args.get_value<std::string>("file"), "archive.tar");
+    EXPECT_EQ(args.get_vec_values<int>("size"), std::vector<int>({3, 4}));
+    EXPECT_EQ(args.num_positionals(), 0);
+
+    std::vector<std::string> attached_file = {"prog", "-xf", "archive.tar"};
+    args = parser.parse_args(attached_file);
+    EXPECT_EQ(args.get_value<std::string>("file"), "archive.tar");
+    EXPECT_EQ(args.num_positionals(), 0);
+
+    std::vector<std::string> clustered_vec = {"prog", "-s3"};
+    args = parser.parse_args(clustered_vec);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    EXPECT_EQ(args.parse_result().errors()[0].code,
+              ErrorCode::InvalidNumOfValues);
+}
+
+TEST(ParserTest, ClusterWithUnknownLetter)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('x', "extract", "extract");
+    parser.add_flag('v', "verbose", "verbose");
+
+    // on their own, unknown options are skipped; only clusters report them
+    std::vector<std::string> cmd_line = {"prog", "-y", "--nope", "-v"};
+    Args args = parser.parse_args(cmd_line);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_EQ(args.num_positionals(), 0);
+
+    std::vector<std::string> cluster = {"prog", "-xqv"};
+    args = parser.parse_args(cluster);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    const ParseError &error = args.parse_result().errors()[0];
+    EXPECT_EQ(error.code, ErrorCode::UnknownShortName);
+    EXPECT_EQ(error.short_name, 'q');
+    EXPECT_EQ(error.token_index, 1);
+    EXPECT_EQ(ParseResult::message(error), "There is no option -q (in -xqv)\n");
+}
+
+TEST(ParserTest, AttachedValuesAndTerminator)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('v', "verbose", "verbose");
+    parser.add_option('n', "num", "a number", false, "0");
+    parser.add_option("pattern", "a pattern", false, "");
+    parser.add_vec_option("size", "width and height", 2, false);
+
+    std::vector<std::string> attached = {
+        "prog", "--num=-3", "--pattern=-v", "-", "--size=3", "4", "-2.5"};
+    std::vector<std::string> negative = {"prog", "-n-7", "--num", "-8",
+                                         "--pattern="};
+    std::vector<std::string> terminated = {"prog", "-v", "--",
+                                           "-n", "--num=1", "--"};
+    std::vector<std::string> flag_with_value = {"prog", "--verbose=yes"};
+
+    Args args = parser.parse_args(attached);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_FALSE(args["verbose"]);
+    EXPECT_EQ(args.get_value<int>("num"), -3);
+    EXPECT_EQ(args.get_value<std::string>("pattern"), "-v");
+    EXPECT_EQ(args.get_vec_values<int>("size"), std::vector<int>({3, 4}));
+    EXPECT_EQ(args.get_all_positionals<std::string>(),
+              std::vector<std::string>({"-", "-2.5"}));
+
+    args = parser.parse_args(negative);
+    EXPECT_EQ(args.get_value<int>("num"), -8);
+    EXPECT_EQ(args.get_value<std::string>("pattern"), "");
+
+    args = parser.parse_args(terminated);
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_EQ(args.get_value<int>("num"), 0);
+    EXPECT_EQ(args.get_all_positionals<std::string>(),
+              std::vector<std::string>({"-n", "--num=1", "--"}));
+
+    args = parser.parse_args(flag_with_value);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    const ParseError &error = args.parse_result().errors()[0];
+    EXPECT_EQ(error.code, ErrorCode::InvalidValue);
+    EXPECT_EQ(error.name, "verbose");
+    EXPECT_EQ(error.value, "yes");
+}
+
+// counts the allocations made through it
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t num_allocations = 0;
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        num_allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, std::size_t bytes,
+                       std::size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST(ParserTest, MemoryResource)
+{
+    Parser parser;
+    parser.add_flag('v', "verbose", "verbose");
+    OptionHandle<int> num = parser.add_option<int>("num", "", false, "1");
+    parser.add_positional("file", "input file");
+    parser.add_subcommand("run", "run it", [](Parser &run) {
+        run.add_option("jobs", "number of jobs", false, "1");
+    });
+
+    CountingResource memory;
+    std::vector<std::string> cmd_line = {"prog", "-v", "--num", "3",
+                                         "file.txt"};
+    Args args = parser.parse_args(cmd_line, &memory);
+    EXPECT_GT(memory.num_allocations, 0);
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_EQ(args[num], 3);
+    EXPECT_EQ(args.get_positional<std::string>("file"), "file.txt");
+
+    memory.num_allocations = 0;
+    std::vector<std::string> subcommand_cmd_line = {"prog", "run", "--jobs",
+                                                    "4"};
+    args = parser.parse_args(subcommand_cmd_line, &memory);
+    EXPECT_GT(memory.num_allocations, 0);
+    EXPECT_EQ(args.subcommand(), "run");
+    EXPECT_EQ(args.get_value<int>("jobs"), 4);
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector<std::string> failing_cmd_line = {"prog", "--num"};
+    Args failed_args = parser.parse_args(failing_cmd_line, &arena);
+    EXPECT_TRUE(failed_args.errors_occured());
+}
+
+TEST(ParserTest, ArgsKeepTheirDefinitions)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_option('o', "opt", "an option", false, "default");
+    parser.add_vec_option('v', "vec", "a vector option", 2, true);
+
+    std::vector<std::string> cmd_line = {"prog", "-v", "1", "2"};
+    Args args = parser.parse_args(cmd_line);
+    for (int i = 0; i < 100; i++)
+    {
+        parser.add_option("opt" + std::to_string(i), "", false, "");
+    }
+    EXPECT_EQ(args.get_value<std::string>("opt"), "default");
+    EXPECT_EQ(args.get_vec_values<int>("vec"), std::vector<int>({1, 2}));
+
+    std::vector<std::string> incomplete_cmd_line = {"prog", "-v", "1", "2",
+                                                    "-v", "3"};
+    args = parser.parse_args(incomplete_cmd_line);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    const ParseError &error = args.parse_result().errors()[0];
+    EXPECT_EQ(error.code, ErrorCode::InvalidNumOfValues);
+    EXPECT_EQ(error.name, "vec");
+    EXPECT_EQ(error.token_index, 4);
+    EXPECT_EQ(error.num_values, 2);
+
+    std::vector<std::string> extended_cmd_line = {"prog", "--opt50", "x",
+                                                  "-v", "1", "2"};
+    args = parser.parse_args(extended_cmd_line);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_EQ(args.get_value<std::string>("opt50"), "x");
+    EXPECT_EQ(args.get_value<std::string>("opt"), "default");
+
+    std::vector<std::string> empty_cmd_line = {"prog"};
+    args = parser.parse_args(empty_cmd_line);
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    EXPECT_EQ(args.parse_result().errors()[0].code, ErrorCode::OptionRequired);
+}
+
+TEST(ParserTest, DefinitionsAfterParsing)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_flag('v', "verbose", "print more");
+
+    std::vector<std::string> cmd_line = {"prog", "-v"};
+    Args args = parser.parse_args(cmd_line);
+
+    // the names are copied for the parser, not changed under the Args
+    parser.add_flag('v', "very", "taken short name");
+    const ParseResult definition_errors = parser.definition_errors();
+    parser.add_flag("verbose", "taken long name");
+    for (int i = 0; i < 100; i++)
+    {
+        parser.add_flag("flag" + std::to_string(i), "");
+    }
+
+    EXPECT_TRUE(args["verbose"]);
+    EXPECT_TRUE(args["v"]);
+    EXPECT_FALSE(args["flag50"]);
+    EXPECT_NE(parser.find("flag50"), nullptr);
+    EXPECT_EQ(definition_errors.messages(),
+              ErrorMessages::short_name_taken('v'));
+    EXPECT_EQ(parser.definition_errors().messages(),
+              ErrorMessages::short_name_taken('v') +
+                  ErrorMessages::long_name_taken("verbose"));
+}
@@ -0,0 +1,135 @@
+#include "StaticSchema.h"
+
+#include <gtest/gtest.h>
+
+using namespace cppargs;
+
+using TestSchema =
+    schema<flag<'v', "verbose">, flag<'x', "extract">, flag<'\0', "dry-run">,
+           option<int, 'n', "num">, option<std::string, '\0', "output">,
+           vec_option<double, 'p', "pos", 3>>;
+
+TEST(StaticSchemaTest, FlagsAndOptions)
+{
+    std::vector<std::string> cmd_line = {
+        "cppargsTEST", "-vx", "--num", "5", "in.txt", "--output", "out.txt",
+        "-p",          "1",   "-2",    "3", "--dry-run"};
+
+    TestSchema::result args = TestSchema::parse(cmd_line);
+
+    EXPECT_TRUE(args.get<"verbose">());
+    EXPECT_TRUE(args.get<"extract">());
+    EXPECT_TRUE(args.get<"dry-run">());
+    EXPECT_EQ(5, args.get<"num">());
+    EXPECT_EQ("out.txt", args.get<"output">());
+    EXPECT_EQ(std::vector<double>({1.0, -2.0, 3.0}), args.get<"pos">());
+    EXPECT_EQ(std::vector<std::string_view>({"in.txt"}), args.positionals);
+
+    EXPECT_TRUE(args.is_given<"num">());
+    EXPECT_FALSE(args.errors_occured());
+}
+
+TEST(StaticSchemaTest, NothingGiven)
+{
+    std::vector<std::string> cmd_line = {"cppargsTEST", "--unknown", "a"};
+
+    TestSchema::result args = TestSchema::parse(cmd_line);
+
+    EXPECT_FALSE(args.get<"verbose">());
+    EXPECT_FALSE(args.is_given<"num">());
+    EXPECT_EQ(0, args.get<"num">());
+    EXPECT_TRUE(args.get<"pos">().empty());
+    EXPECT_EQ(std::vector<std::string_view>({"a"}), args.positionals);
+    EXPECT_FALSE(args.errors_occured());
+}
+
+TEST(StaticSchemaTest, Errors)
+{
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-n", "abc"};
+
+    testing::internal::CaptureStderr();
+    TestSchema::result args = TestSchema::parse(cmd_line);
+    EXPECT_EQ("", testing::internal::GetCapturedStderr());
+
+    EXPECT_TRUE(args.errors_occured());
+    ASSERT_EQ(1, args.parse_result().errors().size());
+    EXPECT_EQ(ErrorCode::InvalidValue, args.parse_result().errors()[0].code);
+    EXPECT_EQ(1, args.parse_result().errors()[0].token_index);
+    EXPECT_EQ(ErrorMessages::invalid_value("num", "abc"),
+              args.parse_result().messages());
+
+    std::vector<std::string> short_cmd_line = {"cppargsTEST", "-p", "1", "2",
+                                               "-v"};
+    args = TestSchema::parse(short_cmd_line);
+
+    EXPECT_TRUE(args.errors_occured());
+    EXPECT_EQ(ErrorMessages::invalid_num_of_values("pos", 3),
+              args.parse_result().messages());
+}
+
+TEST(StaticSchemaTest, Clusters)
+{
+    std::vector<std::string> cmd_line = {"cppargsTEST", "-vn", "5", "-xp1",
+                                         "2", "3"};
+
+    TestSchema::result args = TestSchema::parse(cmd_line);
+
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args.get<"verbose">());
+    EXPECT_TRUE(args.get<"extract">());
+    EXPECT_EQ(5, args.get<"num">());
+    EXPECT_EQ(std::vector<double>({1.0, 2.0, 3.0}), args.get<"pos">());
+    EXPECT_TRUE(args.positionals.empty());
+
+    std::vector<std::string> attached = {"cppargsTEST", "-n5"};
+    args = TestSchema::parse(attached);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_EQ(5, args.get<"num">());
+
+    std::vector<std::string> unknown = {"cppargsTEST", "-vqx"};
+    args = TestSchema::parse(unknown);
+    EXPECT_TRUE(args.get<"verbose">());
+    EXPECT_FALSE(args.get<"extract">());
+    ASSERT_EQ(1, args.parse_result().errors().size());
+    EXPECT_EQ(ErrorCode::UnknownShortName,
+              args.parse_result().errors()[0].code);
+    EXPECT_EQ(ErrorMessages::unknown_short_name('q', "-vqx"),
+              args.parse_result().messages());
+}
+
+TEST(StaticSchemaTest, AttachedValuesAndTerminator)
+{
+    std::vector<std::string> cmd_line = {
+        "cppargsTEST", "--num=5", "--output=out.txt", "--pos=1", "2", "3",
+        "--",          "-v",      "--num=6"};
+
+    TestSchema::result args = TestSchema::parse(cmd_line);
+
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_FALSE(args.get<"verbose">());
+    EXPECT_EQ(5, args.get<"num">());
+    EXPECT_EQ("out.txt", args.get<"output">());
+    EXPECT_EQ(std::vector<double>({1.0, 2.0, 3.0}), args.get<"pos">());
+    EXPECT_EQ(std::vector<std::string_view>({"-v", "--num=6"}),
+              args.positionals);
+
+    std::vector<std::string> flag_with_value = {"cppargsTEST",
+                                                "--verbose=yes"};
+    args = TestSchema::parse(flag_with_value);
+    EXPECT_FALSE(args.get<"verbose">());
+    EXPECT_EQ(ErrorMessages::invalid_value("verbose", "yes"),
+              args.parse_result().messages());
+}
+
+TEST(StaticSchemaTest, PerfectHash)
+{
+    constexpr std::array<std::string_view, 6> names = {
+        "verbose", "extract", "dry-run", "num", "output", "pos"};
+    constexpr auto hash = detail::make_perfect_hash(names);
+    static_assert(hash.is_valid);
+
+    for (std::size_t i = 0; i < names.size(); i++)
+    {
+        EXPECT_EQ(i + 1, hash.slots[hash.slot(names[i])]);
+    }
+}
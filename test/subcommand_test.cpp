@@ -0,0 +1,164 @@
+#include "Parser.h"
+
+#include <gtest/gtest.h>
+
+using namespace cppargs;
+
+namespace {
+
+// tool with "commit" and "push" subcommands, counting how often each is built
+struct Tool
+{
+    Parser parser;
+    int num_commit_builds = 0;
+    int num_push_builds = 0;
+
+    Tool()
+    {
+        parser.add_flag('V', "version", "print version");
+        parser.add_subcommand("commit", "record changes", [this](Parser &p) {
+            num_commit_builds++;
+            p.add_flag('a', "amend", "amend the last commit");
+            p.add_option('m', "message", "commit message", true, "");
+        });
+        parser.add_subcommand("push", "update remote", [this](Parser &p) {
+            num_push_builds++;
+            p.add_positional("remote", "remote name");
+        });
+    }
+};
+
+}  // namespace
+
+TEST(SubcommandTest, OnlySelectedSubcommandIsBuilt)
+{
+    Tool tool;
+
+    std::vector<std::string> cmd_line = {"tool", "commit", "-a", "-m", "fix"};
+    Args args = tool.parser.parse_args(cmd_line);
+
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_EQ(args.subcommand(), "commit");
+    EXPECT_EQ(args.program_name, "tool commit");
+    EXPECT_TRUE(args["amend"]);
+    EXPECT_EQ(args.get_value<std::string>("message"), "fix");
+    EXPECT_EQ(tool.num_commit_builds, 1);
+    EXPECT_EQ(tool.num_push_builds, 0);
+
+    std::vector<std::string> other_cmd_line = {"tool", "commit", "-m", "again"};
+    args = tool.parser.parse_args(other_cmd_line);
+    EXPECT_FALSE(args["amend"]);
+    EXPECT_EQ(tool.num_commit_builds, 1);
+}
+
+TEST(SubcommandTest, SubcommandErrors)
+{
+    Tool tool;
+    tool.parser.set_error_sink(nullptr);
+
+    std::vector<std::string> cmd_line = {"tool", "push"};
+    Args args = tool.parser.parse_args(cmd_line);
+
+    EXPECT_TRUE(args.errors_occured());
+    EXPECT_TRUE(tool.parser.errors_occured());
+    EXPECT_EQ(args.subcommand(), "push");
+    ASSERT_EQ(args.parse_result().errors().size(), 1);
+    EXPECT_EQ(args.parse_result().errors()[0].code,
+              ErrorCode::PositionalRequired);
+}
+
+TEST(SubcommandTest, SettingsOfTheTopLevelParser)
+{
+    Tool tool;
+    tool.parser.set_error_sink(nullptr);
+
+    std::vector<std::string> cmd_line = {"tool", "commit", "--am"};
+    Args args = tool.parser.parse_args(cmd_line);
+    EXPECT_FALSE(args["amend"]);
+    EXPECT_EQ(args.parse_result().errors().size(), 1);
+
+    // changed after the subcommand was built
+    std::vector<std::string> messages;
+    tool.parser.set_error_sink(
+        [&](const std::string &message) { messages.push_back(message); });
+    tool.parser.allow_abbreviations();
+
+    std::vector<std::string> abbreviated = {"tool", "commit", "--am", "-m",
+                                            "fix"};
+    args = tool.parser.parse_args(abbreviated);
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args["amend"]);
+    EXPECT_EQ(tool.num_commit_builds, 1);
+
+    std::vector<std::string> incomplete = {"tool", "commit", "-m"};
+    args = tool.parser.parse_args(incomplete);
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0], ErrorMessages::invalid_num_of_values("message", 1));
+}
+
+TEST(SubcommandTest, WithoutSubcommand)
+{
+    Tool tool;
+
+    std::vector<std::string> cmd_line = {"tool", "-V", "status"};
+    Args args = tool.parser.parse_args(cmd_line);
+
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_TRUE(args.subcommand().empty());
+    EXPECT_TRUE(args["version"]);
+    EXPECT_EQ(args.get_positional<std::string>(0), "status");
+    EXPECT_EQ(tool.num_commit_builds + tool.num_push_builds, 0);
+}
+
+TEST(SubcommandTest, Nested)
+{
+    Parser parser;
+    parser.add_subcommand("remote", "manage remotes", [](Parser &remote) {
+        remote.add_subcommand("add", "add a remote", [](Parser &add) {
+            add.add_positional("name", "remote name");
+        });
+    });
+
+    std::vector<std::string> cmd_line = {"git", "remote", "add", "origin"};
+    Args args = parser.parse_args(cmd_line);
+
+    EXPECT_FALSE(args.errors_occured());
+    EXPECT_EQ(args.subcommand(), "add");
+    EXPECT_EQ(args.program_name, "git remote add");
+    EXPECT_EQ(args.get_positional<std::string>("name"), "origin");
+}
+
+TEST(SubcommandTest, Help)
+{
+    Tool tool;
+
+    std::string help = tool.parser.help_message("tool");
+
+    EXPECT_NE(help.find("[SUBCOMMAND]"), std::string::npos);
+    EXPECT_NE(help.find("SUBCOMMANDS:"), std::string::npos);
+    EXPECT_NE(help.find("record changes"), std::string::npos);
+    EXPECT_EQ(tool.num_commit_builds + tool.num_push_builds, 0);
+
+    testing::internal::CaptureStdout();
+    std::vector<std::string> cmd_line = {"tool", "commit", "-h"};
+    Args args = tool.parser.parse_args(cmd_line);
+    std::string commit_help = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(args.parse_result().help_requested());
+    EXPECT_NE(commit_help.find("tool commit [FLAGS]"), std::string::npos);
+    EXPECT_NE(commit_help.find("--amend"), std::string::npos);
+}
+
+TEST(SubcommandTest, InvalidNames)
+{
+    Parser parser;
+    parser.set_error_sink(nullptr);
+    parser.add_subcommand("commit", "", {});
+    parser.add_subcommand("commit", "", {});
+    parser.add_subcommand("-x", "", {});
+
+    std::span<const ParseError> errors = parser.definition_errors().errors();
+    ASSERT_EQ(errors.size(), 2);
+    EXPECT_EQ(errors[0].code, ErrorCode::SubcommandTaken);
+    EXPECT_EQ(errors[1].code, ErrorCode::InvalidSubcommandName);
+    EXPECT_EQ(errors[1].name, "-x");
+}
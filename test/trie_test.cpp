@@ -0,0 +1,77 @@
+#include "Trie.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace cppargs;
+
+namespace {
+
+std::vector<std::size_t> values_with_prefix(const Trie &trie,
+                                            std::string_view prefix)
+{
+    std::vector<std::size_t> values;
+    trie.visit_prefix(prefix,
+                      [&](std::size_t value) { values.push_back(value); });
+    return values;
+}
+
+}  // namespace
+
+TEST(TrieTest, Find)
+{
+    Trie trie;
+    EXPECT_TRUE(trie.empty());
+    trie.insert("output", 0);
+    trie.insert("out", 1);
+    trie.insert("input", 2);
+
+    EXPECT_FALSE(trie.empty());
+    EXPECT_EQ(trie.find("output"), 0);
+    EXPECT_EQ(trie.find("out"), 1);
+    EXPECT_EQ(trie.find("input"), 2);
+    EXPECT_EQ(trie.find("ou"), Trie::npos);
+    EXPECT_EQ(trie.find("outputs"), Trie::npos);
+    EXPECT_EQ(trie.find(""), Trie::npos);
+
+    trie.insert("out", 3);
+    EXPECT_EQ(trie.find("out"), 3);
+}
+
+TEST(TrieTest, VisitPrefixInOrder)
+{
+    Trie trie;
+    std::vector<std::string> words = {"--verbose", "--version", "-v",
+                                      "--input",   "--in",      "--count"};
+    for (std::size_t i = 0; i < words.size(); i++)
+    {
+        trie.insert(words[i], i);
+    }
+
+    using Values = std::vector<std::size_t>;
+    EXPECT_EQ(values_with_prefix(trie, "--ver"), Values({0, 1}));
+    EXPECT_EQ(values_with_prefix(trie, "--in"), Values({4, 3}));
+    EXPECT_EQ(values_with_prefix(trie, "-"), Values({5, 4, 3, 0, 1, 2}));
+    EXPECT_EQ(values_with_prefix(trie, ""), Values({5, 4, 3, 0, 1, 2}));
+    EXPECT_TRUE(values_with_prefix(trie, "--x").empty());
+}
+
+TEST(TrieTest, FindUnique)
+{
+    Trie trie;
+    trie.insert("--verbose", 0);
+    trie.insert("--version", 1);
+    trie.insert("--output", 2);
+    trie.insert("--output", 3);
+
+    EXPECT_EQ(trie.find_unique("--o"), 3);
+    EXPECT_EQ(trie.find_unique("--output"), 3);
+    EXPECT_EQ(trie.find_unique("--verb"), 0);
+    EXPECT_EQ(trie.find_unique("--ver"), Trie::npos);
+    EXPECT_EQ(trie.find_unique("--x"), Trie::npos);
+    EXPECT_EQ(trie.num_words_with_prefix("--ver"), 2);
+    EXPECT_EQ(trie.num_words_with_prefix("--"), 3);
+    EXPECT_EQ(trie.num_words_with_prefix("--x"), 0);
+}
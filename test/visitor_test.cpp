@@ -0,0 +1,126 @@
+#include "Parser.h"
+
+#include <gtest/gtest.h>
+
+using namespace cppargs;
+
+namespace {
+
+// what was visited, as "kind:name=value" strings
+class Recorder : public ArgumentVisitor
+{
+public:
+    explicit Recorder(const Parser &parser) : parser(parser) {}
+
+    std::vector<std::string> events;
+    // stop after that many events
+    std::size_t max_events = static_cast<std::size_t>(-1);
+
+    bool on_flag(ArgumentId id) override
+    {
+        return record("flag:" + name(id));
+    }
+
+    bool on_option(ArgumentId id, std::string_view value) override
+    {
+        return record("option:" + name(id) + "=" + std::string(value));
+    }
+
+    bool on_positional(std::size_t index, std::string_view value) override
+    {
+        return record("positional:" + std::to_string(index) + "=" +
+                      std::string(value));
+    }
+
+    bool on_error(const ParseError &error) override
+    {
+        record("error:" + ParseResult::message(error));
+        return true;
+    }
+
+private:
+    const Parser &parser;
+
+    std::string name(ArgumentId id) const
+    {
+        for (const char *long_name : {"verbose", "extract", "output", "size"})
+        {
+            if (parser.find(long_name) != nullptr and
+                *parser.find(long_name) == id)
+            {
+                return long_name;
+            }
+        }
+        return "?";
+    }
+
+    bool record(std::string event)
+    {
+        events.push_back(std::move(event));
+        return events.size() < max_events;
+    }
+};
+
+struct Tool
+{
+    Parser parser;
+
+    Tool()
+    {
+        parser.add_flag('v', "verbose", "print more");
+        parser.add_flag('x', "extract", "extract files");
+        parser.add_option('o', "output", "output file", false, "");
+        parser.add_vec_option("size", "width and height", 2, false);
+        parser.add_positional("input", "input file");
+    }
+};
+
+}  // namespace
+
+TEST(VisitorTest, VisitsInCommandLineOrder)
+{
+    Tool tool;
+    Recorder recorder(tool.parser);
+
+    std::vector<std::string> cmd_line = {"prog", "-xv", "in.txt", "-oout.tar",
+                                         "--size", "3", "4", "--", "-v"};
+    EXPECT_TRUE(tool.parser.visit(cmd_line, recorder));
+
+    EXPECT_EQ(recorder.events,
+              std::vector<std::string>(
+                  {"flag:extract", "flag:verbose", "positional:0=in.txt",
+                   "option:output=out.tar", "option:size=3", "option:size=4",
+                   "positional:1=-v"}));
+}
+
+TEST(VisitorTest, Errors)
+{
+    Tool tool;
+    tool.parser.add_option("mode", "mode", true, "");
+    Recorder recorder(tool.parser);
+
+    std::vector<std::string> cmd_line = {"prog", "-vq", "--verbose=1",
+                                         "--size", "3"};
+    EXPECT_TRUE(tool.parser.visit(cmd_line, recorder));
+
+    EXPECT_EQ(recorder.events,
+              std::vector<std::string>(
+                  {"flag:verbose", "error:There is no option -q (in -vq)\n",
+                   "error:" + ErrorMessages::invalid_value("verbose", "1"),
+                   "error:" + ErrorMessages::invalid_num_of_values("size", 2),
+                   "positional:0=3",
+                   "error:" + ErrorMessages::option_required("mode")}));
+}
+
+TEST(VisitorTest, StopsEarly)
+{
+    Tool tool;
+    Recorder recorder(tool.parser);
+    recorder.max_events = 2;
+
+    std::vector<std::string> cmd_line = {"prog", "-v", "a", "b", "c", "d"};
+    EXPECT_FALSE(tool.parser.visit(cmd_line, recorder));
+
+    EXPECT_EQ(recorder.events,
+              std::vector<std::string>({"flag:verbose", "positional:0=a"}));
+}